@@ -2,61 +2,261 @@
 #define CACHE_H
 
 #include <vector>
-#include <map>
 #include <mutex>
+#include <atomic>
+#include <functional>
+#include "Constants.h"
 #include "HardwareComponent.h"
 #include "RAM.h"
+#include "DRAM.h"
+#include "CacheGeometry.h"
+#include "Sampling.h"
+
+// LOCKED: every access takes the set mutex.
+// OPTIMISTIC: read hits validate against the set's sequence counter
+// instead and only fall back to the mutex if a writer raced with them.
+enum class ConcurrencyMode { LOCKED, OPTIMISTIC };
+
+// Instruction fetches are counted separately from data accesses and, with
+// code/data partitioning, fill separate ways.
+enum class AccessKind { DATA = 0, CODE = 1 };
+
+// MESI state of a resident line with respect to the cores in its sharer set
+enum class LineState : char { INVALID, SHARED, EXCLUSIVE, MODIFIED };
+
+// A word the lock-free read path looks at. Loads and stores are relaxed
+// atomics so the reader never races with a writer in the C++ memory
+// model; the set's version counter orders them. Writers still hold the
+// set mutex, so read-modify-write is a plain load/store pair.
+template <typename T>
+class RelaxedAtomic {
+    std::atomic<T> value;
+public:
+    RelaxedAtomic(T v = T{}) : value(v) {}
+    RelaxedAtomic(const RelaxedAtomic& o) : value(o.load()) {}
+    RelaxedAtomic& operator=(const RelaxedAtomic& o) { store(o.load()); return *this; }
+    RelaxedAtomic& operator=(T v) { store(v); return *this; }
+    RelaxedAtomic& operator|=(T v) { store(load() | v); return *this; }
+    operator T() const { return load(); }
+    T load() const { return value.load(std::memory_order_relaxed); }
+    void store(T v) { value.store(v, std::memory_order_relaxed); }
+};
 
 class Cache : public HardwareComponent<Cache> {
     friend class HardwareComponent<Cache>;
     friend class Core;
 
     static RAM* ram;
+    static DRAM* dram;
+    static constexpr int HIT_CYCLES = 4; // access time, in DRAM cycles
     int size;       // total cache size in bytes = numBlocks * BLOCK_SIZE
     int ways;       // associativity
     int numSets;    // number of sets
-    bool partitioningEnabled = true; // partitioning toggle
+    CacheGeometry geom; // address decomposition for numSets
+    int numCores = 0;
+    int codeWays = 0; // code ways per core partition (CDP), 0 = off
+    std::vector<std::atomic<unsigned>> wayMasks; // per core, 0 = default even split
+
+    // Epoch listener (QoS): called every epochLength accesses, outside set locks
+    long long epochLength = 0;
+    std::function<void()> epochListener;
+    std::mutex epochLock;
+    alignas(HOST_CACHE_LINE) std::atomic<long long> epochClock{0};
+    void tick();
+    std::atomic<bool> partitioningEnabled{true}; // partitioning toggle, read by the monitor
+
+    // Way power gating: with partitioning on, ways in no core's mask are
+    // switched off (flushed, then skipped by fills). For the energy model,
+    // activeWayAccesses integrates the powered ways over accesses (dynamic)
+    // and activeWayCycles over simulated time, the slowest core's clock
+    // (leakage); both are brought up to date at every gating change.
+    bool powerGating = false;
+    unsigned activeMask = 0;
+    long long gateEvents = 0;
+    long long wakeEvents = 0;
+    double activeWayAccesses = 0.0;
+    long long accessesAtUpdate = 0;
+    double activeWayCycles = 0.0;
+    long long cyclesAtUpdate = 0;
+    std::atomic<long long> gatingWritebacks{0}; // bytes written back by flushes
+    std::mutex gatingLock;
+    void updateGating();
+    void flushWays(unsigned mask);
+    unsigned allWays() const { return lowWays(ways); }
+    long long totalAccesses() const;
+    long long simulatedCycles() const;
+    ConcurrencyMode concurrencyMode = ConcurrencyMode::LOCKED;
 
     Cache(int = 1, int = 2);
 
-    void copyBlockUnlocked(int blockNum, int coreId);
+    int copyBlockUnlocked(int blockNum, int coreId, AccessKind kind = AccessKind::DATA, bool detailed = true);
+    void wayRange(int coreId, AccessKind kind, int& lo, int& hi) const;
+
+    // Single-line access (see Cache.cpp)
+    void accessImpl(int addr, int* data, int count, int coreId, bool write, AccessKind kind);
+    bool tryOptimisticRead(int addr, int* data, int count, int setIndex, int tag, int coreId,
+                           AccessKind kind, bool detailed);
+    void warm(int addr, int* data, int count, int coreId, bool write, AccessKind kind, int setIndex, int tag);
+
+    void accessRange(int addr, int* data, int count, int coreId, bool write);
 
 protected:
+    // One per set, padded so neighbouring sets never share a host line.
+    // version is odd while a writer holds mutex and is mutating the set.
+    struct alignas(HOST_CACHE_LINE) SetLock {
+        std::mutex mutex;
+        std::atomic<unsigned> version{0};
+    };
+
+    // Per-core counters, written only by the owning core's thread
+    // (except lines, which a fill by any core may decrement)
+    struct alignas(HOST_CACHE_LINE) CoreCounters {
+        std::atomic<long long> hits{0};
+        std::atomic<long long> misses{0};
+        std::atomic<long long> ramReads{0};
+        std::atomic<long long> ramWrites{0};
+        std::atomic<long long> lines{0};     // cache lines currently owned
+        std::atomic<long long> splitAccesses{0}; // accesses spanning two or more lines
+        std::atomic<long long> fetchHits{0};
+        std::atomic<long long> fetchMisses{0};
+        std::atomic<long long> invalidations{0};     // copies removed from other cores
+        std::atomic<long long> upgrades{0};          // SHARED -> MODIFIED by a sharer
+        std::atomic<long long> coherenceMessages{0}; // invalidations, upgrades, downgrades
+        std::atomic<long long> bypassed{0};          // data accesses to unsampled sets
+    };
+
+    // Set sampling: per sampled set, detailed data accesses
+    struct SetSample {
+        std::atomic<long long> hits{0};
+        std::atomic<long long> accesses{0};
+    };
+
+    // Window sampling, owned by the core's thread
+    struct alignas(HOST_CACHE_LINE) SamplerState {
+        long long phase = 0;         // position in the warm + window period
+        bool started = false;        // an access has been seen
+        long long lastHits = 0;      // counters at the end of the last window
+        long long lastAccesses = 0;
+        std::vector<SampleUnit> windows;
+    };
+
+    // tag and sharers are read by tryOptimisticRead without the set mutex
     struct CacheLineInfo {
-        int wayIndex;
-        int ownerCore; // -1 if free or shared
+        RelaxedAtomic<int> tag = -1; // -1 if the line is free
+        int ownerCore = -1; // core that filled the line, -1 if free
+        bool dirty = false; // differs from RAM
+        LineState state = LineState::INVALID;
+        RelaxedAtomic<unsigned> sharers = 0u; // bit c set if core c holds a copy
     };
 
-    std::vector<std::vector<int>> lastWrite;               // lastWrite[set][core]
-    std::vector<std::map<int, CacheLineInfo>> tags;        // tags[set][tag] -> CacheLineInfo
-    std::vector<int> mem;                                  // linear storage
-    std::vector<std::mutex> setLocks;                      // per-set locks
-    std::vector<std::vector<char>> dirty;                 // dirty[set][way]
+    void applyCoherence(CacheLineInfo& line, CoreCounters& cc, int coreId, bool write);
 
-    // Counters
-    int cacheHits = 0;
-    int cacheMisses = 0;
-    int ramReads = 0;
-    int ramWrites = 0;
+    std::vector<std::vector<int>> lastWrite;               // lastWrite[set][core * 2 + kind]
+    std::vector<CacheLineInfo> lines;                      // lines[set * ways + way]
+    std::vector<RelaxedAtomic<int>> mem;                   // linear storage
+    std::vector<SetLock> setLocks;                         // per-set locks
+    std::vector<CoreCounters> counters;                    // counters[core]
+
+    SamplingConfig sampling;
+    std::vector<CoreCounters> warmCounters;                // discarded stats of warming accesses
+    std::vector<SetSample> setSamples;                     // setSamples[set]
+    std::vector<SamplerState> samplers;                    // samplers[core]
+    bool inWindow(int coreId);
+    void bypass(int addr, int* data, int count, int coreId, bool write, int setIndex);
+    void flushSet(int setIndex, unsigned wayMask);
+
+    static long long sum(const std::vector<CoreCounters>&, std::atomic<long long> CoreCounters::*);
 
 public:
+    // Point-in-time copy of one core's counters; safe to take from any
+    // thread while the simulation runs (no set locks involved).
+    struct CoreSnapshot {
+        long long hits = 0;
+        long long misses = 0;
+        long long ramReads = 0;
+        long long ramWrites = 0;
+        long long lines = 0;
+        long long fetchHits = 0;
+        long long fetchMisses = 0;
+    };
+
     void init();
     static Cache* createInstance(int, int);
 
     // API
-    int get(int addr, int coreId);
-    void set(int addr, int val, int coreId);
+    int get(int addr, int coreId) {
+        int val;
+        accessImpl(addr, &val, 1, coreId, false, AccessKind::DATA);
+        if (epochLength > 0) tick();
+        return val;
+    }
+    void set(int addr, int val, int coreId) {
+        accessImpl(addr, &val, 1, coreId, true, AccessKind::DATA);
+        if (epochLength > 0) tick();
+    }
+    // Instruction fetch of the line holding addr (tag/stat effect only)
+    void fetch(int addr, int coreId) {
+        accessImpl(addr, nullptr, 0, coreId, false, AccessKind::CODE);
+        if (epochLength > 0) tick();
+    }
+    // Multi-byte accesses: one lookup per touched line
+    void read(int addr, int* data, int count, int coreId) { accessRange(addr, data, count, coreId, false); }
+    void write(int addr, const int* data, int count, int coreId) {
+        accessRange(addr, const_cast<int*>(data), count, coreId, true); // not modified on writes
+    }
     void copyBlock(int blockNum, int coreId);
     void resetStats();
 
-    void setPartitioning(bool enable) { partitioningEnabled = enable; }
-    bool isPartitioned() const { return partitioningEnabled; }
+    void setPartitioning(bool enable);
+    bool isPartitioned() const { return partitioningEnabled.load(std::memory_order_relaxed); }
+    // CAT-style allocation: a contiguous, non-empty bitmask of the ways
+    // coreId may fill while partitioning is enabled. 0 restores the default.
+    void setWayMask(int coreId, unsigned mask);
+    unsigned getWayMask(int coreId) const;
+    void setWayMasks(const std::vector<unsigned>& masks); // all cores at once
+    // Mask of ways [0, n); n == 32 is valid, unlike a plain 1u << n
+    static unsigned lowWays(int n) { return n >= 32 ? ~0u : (1u << n) - 1u; }
+    void resetWayMasks();
+    void setPowerGating(bool enable);
+    bool isPowerGating() const { return powerGating; }
+    void setEpochListener(long long epochAccesses, std::function<void()> listener);
+    void clearEpochListener();
+
+    // Must leave at least one data way in the default per-core partition
+    void setCodeWays(int n);
+    int getCodeWays() const { return codeWays; }
+    void setConcurrencyMode(ConcurrencyMode mode) { concurrencyMode = mode; }
+    // Unsampled sets are flushed; sampling state restarts
+    void setSampling(const SamplingConfig& cfg);
+    const SamplingConfig& getSampling() const { return sampling; }
+    ConcurrencyMode getConcurrencyMode() const { return concurrencyMode; }
 
     // Stats
-    int getCacheHits() const { return cacheHits; }
-    int getCacheMisses() const { return cacheMisses; }
-    int getRamReads() const { return ramReads; }
-    int getRamWrites() const { return ramWrites; }
+    int getCacheHits() const { return static_cast<int>(sum(counters, &CoreCounters::hits)); }
+    int getCacheMisses() const { return static_cast<int>(sum(counters, &CoreCounters::misses)); }
+    int getRamReads() const { return static_cast<int>(sum(counters, &CoreCounters::ramReads)); }
+    int getRamWrites() const {
+        return static_cast<int>(sum(counters, &CoreCounters::ramWrites) + gatingWritebacks.load(std::memory_order_relaxed));
+    }
+    int getSplitAccesses() const { return static_cast<int>(sum(counters, &CoreCounters::splitAccesses)); }
+    int getFetchHits() const { return static_cast<int>(sum(counters, &CoreCounters::fetchHits)); }
+    int getFetchMisses() const { return static_cast<int>(sum(counters, &CoreCounters::fetchMisses)); }
+    int getInvalidations() const { return static_cast<int>(sum(counters, &CoreCounters::invalidations)); }
+    int getUpgrades() const { return static_cast<int>(sum(counters, &CoreCounters::upgrades)); }
+    int getCoherenceMessages() const { return static_cast<int>(sum(counters, &CoreCounters::coherenceMessages)); }
+    CoreSnapshot getCoreSnapshot(int coreId) const;
+    int getNumCores() const { return static_cast<int>(counters.size()); }
+    long long getGateEvents() const { return gateEvents; }     // ways switched off
+    long long getWakeEvents() const { return wakeEvents; }     // ways switched on
+    unsigned getActiveWayMask() const { return activeMask; }
+    double getAverageActiveWays();                             // access-weighted
+    double getActiveWayCycles();                               // powered ways x cycles
+    long long getBypassedAccesses() const { return sum(counters, &CoreCounters::bypassed); }
+    long long getWarmAccesses() const {
+        return sum(warmCounters, &CoreCounters::hits) + sum(warmCounters, &CoreCounters::misses);
+    }
+    std::vector<SampleUnit> getSetSamples() const;    // one unit per sampled set
+    std::vector<SampleUnit> getWindowSamples() const; // one unit per window, all cores
 
     // Helpers
     int getNumSets() const { return numSets; }
@@ -0,0 +1,31 @@
+#ifndef CACHEGEOMETRY_H
+#define CACHEGEOMETRY_H
+
+#include "Constants.h"
+
+constexpr int log2Exact(int n) { return n <= 1 ? 0 : 1 + log2Exact(n / 2); }
+constexpr bool isPowerOfTwo(int n) { return n > 0 && (n & (n - 1)) == 0; }
+
+static_assert(isPowerOfTwo(BLOCK_SIZE), "BLOCK_SIZE must be a power of two");
+
+// Address decomposition for the Cache access path. Block number and offset
+// are shifts by the compile-time BLOCK_SIZE; set index and tag are a mask
+// and a shift when the set count is a power of two (every default
+// geometry), and a division otherwise.
+struct CacheGeometry {
+  static constexpr int blockBits = log2Exact(BLOCK_SIZE);
+
+  int numSets = 1;
+  int setBits = 0;
+  bool pow2 = true;
+
+  CacheGeometry() = default;
+  explicit CacheGeometry(int sets) : numSets(sets), setBits(log2Exact(sets)), pow2(isPowerOfTwo(sets)) {}
+
+  static int block(int addr) { return addr >> blockBits; }
+  static int offset(int addr) { return addr & (BLOCK_SIZE - 1); }
+  int setOf(int blockNum) const { return pow2 ? blockNum & (numSets - 1) : blockNum % numSets; }
+  int tagOf(int blockNum) const { return pow2 ? blockNum >> setBits : blockNum / numSets; }
+};
+
+#endif
@@ -1,4 +1,5 @@
 #pragma once
 
 constexpr int SYSTEM_BITS = 16; // must be multiple of 8
-constexpr int BLOCK_SIZE = 32;
\ No newline at end of file
+constexpr int BLOCK_SIZE = 32;
+constexpr int HOST_CACHE_LINE = 64; // host line size, for padding shared state
\ No newline at end of file
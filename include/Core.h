@@ -1,30 +1,55 @@
 #ifndef CORE_H
 #define CORE_H
 
+#include <array>
 #include <thread>
+#include <vector>
 #include "RAM.h"
 #include "Cache.h"
+#include "ICache.h"
 #include "Instruction.h"
 #include "Process.h"
 
+// BYPASS: instruction fetch is free and invisible to the caches.
+// SPLIT: fetches go through a private per-core ICache.
+// UNIFIED: fetches go through the shared Cache as code accesses.
+enum class FetchMode { BYPASS, SPLIT, UNIFIED };
+
 class Core {
   static RAM* ram;
   static Cache* cache;
+  static FetchMode fetchMode;
+  static int icacheBlocks, icacheWays;
   int id, pc, dataAddr = -1;
+  int codeAddr = -1, fetchBlock = -1;
+  std::vector<Instruction> code; // pre-decoded program, code[(pc - codeAddr) / 2]
+  ICache icache;
   char acc;
+  std::array<int, 8> wide{}; // 32-byte register for LOADn/STOREn, 4 bytes per word
   Instruction ir;
   bool busy = false;
 
   void runInstruction();
+  void decode(int, int);
+  void fetch(int);
   void loadIR();
   void load(int);
   void store(int);
   void set(char);
+  void checkRange(int, int) const;
+  void loadWide(int, int);
+  void storeWide(int, int);
+  void copyBytes(int, int, int);
+  void fillBytes(int, int);
 public:
   Core(int);
   int getId() const;
   bool isBusy() const;
   std::thread runProcess(Process&);
+  const ICache& getICache() const { return icache; }
+
+  static void setFetchMode(FetchMode, int icacheBlocks = 8, int icacheWays = 2);
+  static FetchMode getFetchMode() { return fetchMode; }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,127 @@
+#ifndef DRAM_H
+#define DRAM_H
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include "Constants.h"
+#include "HardwareComponent.h"
+
+enum class PagePolicy { OPEN, CLOSED };
+
+struct DRAMConfig {
+  int channels = 1;
+  int ranks = 1;
+  int banks = 8;          // banks per rank
+  int rowBlocks = 32;     // cache blocks per DRAM row
+  int queueDepth = 16;    // scheduler window (pending requests)
+  PagePolicy policy = PagePolicy::OPEN;
+
+  // Timing, in DRAM cycles
+  int tCAS = 11;
+  int tRCD = 11;
+  int tRP = 11;
+  int tBurst = 4;         // data bus occupancy per block
+
+  // Energy, same arbitrary units as EnergyModel
+  double E_activate = 900.0;
+  double E_precharge = 500.0;
+  double E_read = 800.0;  // per block burst
+  double E_write = 1100.0;
+};
+
+// Timing/energy model of the memory behind RAM. RAM still holds the data;
+// the Cache reports every block fill and writeback here, and requests are
+// scheduled FR-FCFS (row hits first, then oldest) over a bounded window.
+//
+// Each core has a simulated clock: cache accesses advance it by their hit
+// time, requests arrive at the core's current time, and a read (a fill)
+// stalls the core until its data returns. Writebacks are posted.
+class DRAM : public HardwareComponent<DRAM> {
+  friend class HardwareComponent<DRAM>;
+
+  struct Request {
+    long long id;
+    int blockNum;
+    int coreId;
+    bool write;
+    long long arrival;
+  };
+
+  struct Bank {
+    int openRow = -1;       // -1 if precharged
+    long long readyAt = 0;
+    long long busySince = 0;  // start of the last contended command
+  };
+
+  // Written only by the core's own thread
+  struct alignas(HOST_CACHE_LINE) CoreClock {
+    std::atomic<long long> now{0};
+  };
+
+public:
+  struct CoreStats {
+    long long reads = 0;
+    long long writes = 0;
+    long long rowHits = 0;
+    long long rowMisses = 0;
+    long long bytes = 0;
+    long long latency = 0;  // sum of request latencies, in cycles
+    double throttle = 0.0;  // MBA-style delay level, 0 = unthrottled
+    long long nextIssue = 0;
+  };
+
+private:
+  DRAMConfig cfg;
+  std::vector<Bank> banks;              // banks[(channel * ranks + rank) * banks + bank]
+  std::vector<long long> busFreeAt;     // per channel
+  std::vector<Request> queue;
+  std::vector<CoreStats> coreStats;
+  std::vector<CoreClock> clocks;        // clocks[core]
+  std::mutex lock;
+
+  long long nextId = 0;
+  long long elapsed = 0;                // completion time of the last request
+  long long activations = 0;
+  long long precharges = 0;
+  double energy = 0.0;
+
+  DRAM(const DRAMConfig& = DRAMConfig{}, int numCores = 1);
+
+  void decode(int blockNum, int& bankIndex, int& channel, int& row) const;
+  Request serviceOne(long long& done);
+  CoreStats& statsFor(int coreId);
+  const CoreStats& statsFor(int coreId) const;
+
+public:
+  static DRAM* createInstance(const DRAMConfig&, int numCores);
+
+  // Queues a request at coreId's current time; a read returns once it is
+  // serviced and moves the core's clock to its completion
+  void access(int blockNum, int coreId, bool write);
+  void advance(int coreId, long long cycles) {
+    std::atomic<long long>& c = clocks[static_cast<size_t>(coreId)].now;
+    c.store(c.load(std::memory_order_relaxed) + cycles, std::memory_order_relaxed);
+  }
+  // Limit coreId to (1 - level) of a channel's peak bandwidth, level in
+  // [0, MAX_THROTTLE]; a throttled fill stalls the core until it may issue
+  static constexpr double MAX_THROTTLE = 0.99;
+  void setThrottle(int coreId, double level);
+  double getThrottle(int coreId);
+  void drain();
+  void reset();
+
+  const DRAMConfig& getConfig() const { return cfg; }
+  int getNumCores() const { return static_cast<int>(coreStats.size()); }
+  const CoreStats& getCoreStats(int coreId) const { return statsFor(coreId); }
+  long long getCycles(int coreId) const;  // coreId's simulated time
+  long long getElapsedCycles() const;
+  long long getActivations() const { return activations; }
+  long long getPrecharges() const { return precharges; }
+  double getEnergy() const { return energy; }
+  double getRowHitRate() const;
+  double getBandwidth(int coreId) const;  // bytes per cycle of coreId's time
+  double getRowHitRate(int coreId) const;
+};
+
+#endif
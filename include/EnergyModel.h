@@ -0,0 +1,31 @@
+#ifndef ENERGYMODEL_H
+#define ENERGYMODEL_H
+
+// -----------------------------
+// Parameterized cache energy/power model, in the same arbitrary units as
+// DRAMConfig. Dynamic energy per access scales with array size (sqrt, for
+// bitline/wordline length), with associativity (all ways are read in
+// parallel) and with the tag bits compared per way. Leakage is charged per
+// powered-on byte per simulated cycle. Power gating switches off whole ways
+// at a cost per transition.
+// -----------------------------
+struct EnergyModel {
+    // Dynamic energy of a reference array (1 KB, 8-way, excluding tags)
+    double E_ref_access = 1.0;
+    double refSizeBytes = 1024.0;
+    double refWays = 8.0;
+    double sizeExponent = 0.5;
+    double wayWeight = 0.1;             // relative cost of each extra way read
+    double E_tag_bit = 0.005;           // per tag bit compared, per way
+
+    double leakagePerByteCycle = 1e-4;  // static power
+    double E_gate = 20.0;               // per way switched off
+    double E_wakeup = 40.0;             // per way switched back on
+    double E_coherence = 5.0;           // per coherence message
+
+    static int tagBits(int sets);
+    double accessEnergy(double sizeBytes, double ways, int sets) const;
+    double leakage(double activeBytes, double cycles) const;
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef ICACHE_H
+#define ICACHE_H
+
+#include <vector>
+
+// Private per-core instruction cache for FetchMode::SPLIT. Instructions
+// are executed from the core's pre-decoded array, so only tags and
+// round-robin replacement state are kept.
+class ICache {
+  static constexpr int HIT_CYCLES = 1; // access time, in DRAM cycles
+
+  int ways;
+  int numSets;
+  std::vector<int> tags;       // tags[set * ways + way], -1 if free
+  std::vector<int> lastWrite;  // lastWrite[set]
+
+  long long hits = 0;
+  long long misses = 0;
+
+public:
+  ICache(int numBlocks = 8, int ways = 2);
+
+  // Returns true on a hit; a miss fills the line from memory
+  bool fetch(int addr, int coreId);
+  void reset();
+
+  long long getHits() const { return hits; }
+  long long getMisses() const { return misses; }
+  int getNumSets() const { return numSets; }
+  int getWays() const { return ways; }
+};
+
+#endif
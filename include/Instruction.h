@@ -1,13 +1,32 @@
 #ifndef INSTRUCTION_H
 #define INSTRUCTION_H
 
-enum class Operator { SET, LOAD, STORE, EXECUTE };
+// LOADn/STOREn move n bytes between memory and the wide register.
+// MEMCPY/MEMSET pack their operands into one word (see bulkOperand);
+// MEMSET fills with the accumulator.
+enum class Operator {
+  SET, LOAD, STORE, EXECUTE,
+  LOAD4, LOAD8, LOAD16, LOAD32,
+  STORE4, STORE8, STORE16, STORE32,
+  MEMCPY, MEMSET
+};
+
+constexpr int BULK_ADDR_BITS = 12;                  // per address field
+constexpr int BULK_ADDR_LIMIT = 1 << BULK_ADDR_BITS; // exclusive
+constexpr int BULK_MAX_LEN = 255;                   // bytes per bulk instruction
 
 struct Instruction {
   Operator op;
   int operand;
   Instruction() = default;
   Instruction(Operator, int);
+
+  int width() const;      // bytes moved by LOADn/STOREn, 1 for LOAD/STORE
+  int bulkSrc() const;
+  int bulkDst() const;
+  int bulkLen() const;
+  // [len:8][dst:12][src:12]
+  static int bulkOperand(int dst, int src, int len);
 };
 
-#endif
\ No newline at end of file
+#endif
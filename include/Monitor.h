@@ -0,0 +1,47 @@
+#ifndef MONITOR_H
+#define MONITOR_H
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <thread>
+#include <vector>
+#include "Cache.h"
+
+// Live ncurses dashboard. A UI thread samples the cache's per-core counters
+// every period (relaxed loads only, no set locks) and redraws per-core hit
+// rate, RAM traffic, way allocation and access rate as scrolling sparklines.
+class Monitor {
+  struct CoreHistory {
+    Cache::CoreSnapshot last;
+    std::deque<double> hitRate;     // per interval, 0..1
+    std::deque<double> ramTraffic;  // bytes per second
+    std::deque<double> ways;        // ways in the core's allocation
+    std::deque<double> accessRate;  // accesses per second
+  };
+
+  Cache* cache;
+  int numCores;
+  std::chrono::milliseconds period;
+  std::vector<CoreHistory> history;
+  std::atomic<bool> running{false};
+  std::thread ui;
+  std::chrono::steady_clock::time_point startedAt, lastSample;
+
+  void loop();
+  void sample();
+  void draw() const;
+
+public:
+  static constexpr size_t HISTORY = 64;
+
+  Monitor(Cache*, int periodMs = 250);
+  ~Monitor();
+  Monitor(const Monitor&) = delete;
+  Monitor& operator=(const Monitor&) = delete;
+
+  bool start();   // false if stdout is not a terminal
+  void stop();
+};
+
+#endif
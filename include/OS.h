@@ -5,6 +5,7 @@
 #include "CPU.h"
 #include "RAM.h"
 #include "Cache.h"
+#include "DRAM.h"
 #include "Process.h"
 
 class OS {
@@ -12,6 +13,7 @@ class OS {
   CPU* cpu;
   RAM* ram;
   Cache* cache;
+  DRAM* dram;
   OS(int cpu_cores = 2, int ram_size = 32, int cache_size = 4, int cache_ways = 2);
 public:
   static OS* createInstance(int, int, int, int);
@@ -19,6 +21,7 @@ public:
   CPU* getCPU() const;
   RAM* getRAM() const;
   Cache* getCache() const;
+  DRAM* getDRAM() const;
   void loadProcess(Process&);
 };
 
@@ -20,6 +20,7 @@ public:
   int instructionsCount() const;
   int getAddr() const;
   static Process createRandom(int, int);
+  static void seedRandom(unsigned);
 };
 
 #endif
\ No newline at end of file
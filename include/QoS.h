@@ -0,0 +1,74 @@
+#ifndef QOS_H
+#define QOS_H
+
+#include <string>
+#include <vector>
+#include "Cache.h"
+#include "DRAM.h"
+
+enum class Priority { LATENCY_CRITICAL, BATCH };
+
+struct QoSTarget {
+  Priority priority = Priority::BATCH;
+  double maxMissRate = 1.0;       // SLA of latency-critical cores, per epoch
+  long long bandwidthBudget = 0;  // batch cores: RAM bytes per BUDGET_CYCLES of the
+                                  // core's simulated time, 0 = unlimited
+};
+
+// Feedback controller for partitioned runs. Every epoch (a fixed number of
+// cache accesses across all cores) it checks each core against its target,
+// moves ways towards latency-critical cores that miss their SLA (first
+// from unallocated ways, then from the batch core holding the most), hands
+// them back once the SLA is met with margin, and throttles the DRAM rate of
+// batch cores that exceed their bandwidth budget. Bandwidth is measured
+// over each core's simulated clock, which a throttled core's fills stall,
+// so throttling lowers the measured value. Way masks stay contiguous and
+// are laid out in core order.
+class QoSController {
+public:
+  struct CoreReport {
+    QoSTarget target;
+    std::vector<bool> met;        // SLA met, per epoch
+    std::vector<int> ways;        // allocation at the end of each epoch
+    int allocated = 0;            // final allocation, even if no epoch ended
+    double throttle = 0.0;        // final DRAM throttle level
+    double attainment() const;    // fraction of epochs met
+    std::string timeline(size_t width) const;
+  };
+
+private:
+  Cache* cache;
+  DRAM* dram;
+  std::vector<QoSTarget> targets;
+  long long epochAccesses;
+  std::vector<int> allocation;    // ways per core
+  std::vector<Cache::CoreSnapshot> last;
+  std::vector<long long> lastCycles;
+  std::vector<CoreReport> reports;
+  int epochs = 0;
+
+  static constexpr double RELEASE_MARGIN = 0.5;  // give a way back below margin * target
+  static constexpr double THROTTLE_FACTOR = 2.0;  // allowed bandwidth halves/doubles per epoch
+
+public:
+  static constexpr long long BUDGET_CYCLES = 1000;
+
+private:
+
+  void onEpoch();
+  void applyAllocation();
+
+public:
+  QoSController(Cache*, DRAM*, std::vector<QoSTarget>, long long epochAccesses = 256);
+
+  void attach();   // starts controlling; partitioning must be enabled
+  void detach();   // restores default masks and removes throttles
+
+  int getEpochs() const { return epochs; }
+  const std::vector<CoreReport>& getReports() const { return reports; }
+
+  // Parses "lc:0.1,batch:500,batch" (one entry per core; missing cores are batch)
+  static std::vector<QoSTarget> parseTargets(const std::string&, int numCores);
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <functional>
+
+// Two-sided Student-t critical value, e.g. tQuantile(0.95, 9) = 2.262
+double tQuantile(double confidence, long long df);
+
+// Streaming mean/variance (Welford's algorithm)
+class RunningStat {
+  long long n = 0;
+  double mean = 0.0;
+  double m2 = 0.0;
+public:
+  void add(double x);
+  long long count() const { return n; }
+  double getMean() const { return mean; }
+  double variance() const;            // sample variance
+  double halfWidth(double confidence) const; // CI half-width, t(n - 1) * standard error
+};
+
+struct ReplicationConfig {
+  double hitRateCIWidth = 0.01;  // full CI width of the hit-rate delta (fraction)
+  double energyCIWidth = 0.1;    // full CI width of the relative energy delta,
+                                 // as a fraction of its mean...
+  double energyCIFloor = 0.005;  // ...or this absolute width, whichever is larger
+  double confidence = 0.95;
+  int minTrials = 10;
+  int maxTrials = 500;
+  int jobs = 1;                  // trials run concurrently
+  unsigned baseSeed = 1;
+};
+
+// Partitioned minus shared, from one pair of runs on the same processes
+struct TrialResult {
+  double hitRateDelta = 0.0;     // absolute, as a fraction
+  double energyDelta = 0.0;      // relative to shared energy
+};
+
+struct ReplicationReport {
+  RunningStat hitRate;
+  RunningStat energy;
+  int trials = 0;
+  bool converged = false;        // false if maxTrials was reached first
+};
+
+// Runs paired trials with seeds baseSeed, baseSeed + 1, ... in batches of
+// `jobs` and stops once both CI widths are under target. The simulator
+// components are process-wide singletons, so every trial runs in a forked
+// child and sends its result back over a pipe.
+class ReplicationDriver {
+  ReplicationConfig cfg;
+  std::function<TrialResult(unsigned)> trial;
+
+  void startTrial(unsigned seed, int& pid, int& fd) const;
+  static bool finishTrial(int pid, int fd, TrialResult& r);
+  bool done(const ReplicationReport&) const;
+
+public:
+  ReplicationDriver(const ReplicationConfig&, std::function<TrialResult(unsigned)>);
+  ReplicationReport run();
+};
+
+#endif
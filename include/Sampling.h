@@ -0,0 +1,48 @@
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include <vector>
+
+// Statistical sampling of the cache (see Cache::setSampling). Both modes
+// can be combined; the defaults simulate everything in detail.
+struct SamplingConfig {
+  // Set sampling: only every setStride-th set is simulated; accesses to
+  // the other sets go straight to RAM and are not counted.
+  int setStride = 1;
+  // SMARTS-style windows: per core, warmLength accesses of functional
+  // warming followed by windowLength accesses measured in detail. 0 = off.
+  // Warming keeps tags, replacement state and data, and skips coherence,
+  // stats and the DRAM model (see Cache::warm).
+  long long warmLength = 0;
+  long long windowLength = 100;
+
+  bool setSampling() const { return setStride > 1; }
+  bool windowSampling() const { return warmLength > 0; }
+};
+
+// One sampling unit (a set, or a detailed window of one core)
+struct SampleUnit {
+  long long hits = 0;
+  long long accesses = 0;
+};
+
+// Fewer units than this give a point estimate only
+constexpr int MIN_SAMPLE_UNITS = 5;
+
+struct SampleEstimate {
+  double hitRate = 0.0;
+  double halfWidth = 0.0;        // CI half-width, t(units - 1) * standard error;
+                                 // INFINITY below MIN_SAMPLE_UNITS units
+  int units = 0;
+  long long sampledAccesses = 0;
+};
+
+// Ratio estimator over clustered units: hitRate = sum(hits) / sum(accesses),
+// with the variance of the residuals hits - hitRate * accesses across units
+// and a finite-population correction for the sampled fraction. If every
+// unit has the same rate the bound falls back to the binomial one over
+// all sampled accesses (3 / n, the rule of three, at 0% or 100%).
+SampleEstimate estimateHitRate(const std::vector<SampleUnit>& units, double sampledFraction,
+                               double confidence = 0.95);
+
+#endif
@@ -1,4 +1,3 @@
 #pragma once
-#include <vector>
-void storeBytes(std::vector<int>::iterator, int, int);
-int loadBytes(std::vector<int>::const_iterator, int);
\ No newline at end of file
+void storeBytes(int*, int, int);
+int loadBytes(const int*, int);
\ No newline at end of file
@@ -2,19 +2,49 @@
 #include "RAM.h"
 #include "CPU.h"
 #include "Constants.h"
+#include <algorithm>
+#include <bitset>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 
 RAM* Cache::ram = nullptr;
+DRAM* Cache::dram = nullptr;
+
+namespace {
+
+constexpr int MAX_OPTIMISTIC_RETRIES = 8;
+
+// Counter slots have a single writer, so a relaxed load/store pair is enough
+inline void bump(std::atomic<long long>& c, long long n = 1) {
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+// Holds a set's version odd for the lifetime of the scope; the set mutex
+// must already be held.
+class SeqWriteScope {
+    std::atomic<unsigned>& version;
+public:
+    explicit SeqWriteScope(std::atomic<unsigned>& v) : version(v) {
+        version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+    ~SeqWriteScope() {
+        version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+};
+
+}
 
 Cache::Cache(int numBlocks, int w) : size(numBlocks * BLOCK_SIZE), ways(w), numSets(0) {
     if (numBlocks <= 0 || w <= 0) throw std::runtime_error("Invalid cache config");
     if (numBlocks % w != 0) throw std::runtime_error("Blocks must be divisible by ways");
     numSets = numBlocks / w;
     mem.assign(static_cast<size_t>(numSets) * static_cast<size_t>(ways) * BLOCK_SIZE, 0);
-    tags.assign(static_cast<size_t>(numSets), std::map<int, CacheLineInfo>{});
-    setLocks = std::vector<std::mutex>(static_cast<size_t>(numSets));
-    dirty.assign(static_cast<size_t>(numSets), std::vector<char>(static_cast<size_t>(ways), 0));
+    lines.assign(static_cast<size_t>(numSets) * static_cast<size_t>(ways), CacheLineInfo{});
+    setLocks = std::vector<SetLock>(static_cast<size_t>(numSets));
+    setSamples = std::vector<SetSample>(static_cast<size_t>(numSets));
+    geom = CacheGeometry(numSets);
 }
 
 Cache* Cache::createInstance(int s, int w) {
@@ -22,141 +52,573 @@ Cache* Cache::createInstance(int s, int w) {
   return instance.get();
 }
 
+long long Cache::sum(const std::vector<CoreCounters>& cs, std::atomic<long long> CoreCounters::*field) {
+    long long total = 0;
+    for (const CoreCounters& c : cs)
+        total += (c.*field).load(std::memory_order_relaxed);
+    return total;
+}
+
+Cache::CoreSnapshot Cache::getCoreSnapshot(int coreId) const {
+    const CoreCounters& c = counters[static_cast<size_t>(coreId)];
+    CoreSnapshot s;
+    s.hits = c.hits.load(std::memory_order_relaxed);
+    s.misses = c.misses.load(std::memory_order_relaxed);
+    s.ramReads = c.ramReads.load(std::memory_order_relaxed);
+    s.ramWrites = c.ramWrites.load(std::memory_order_relaxed);
+    s.lines = c.lines.load(std::memory_order_relaxed);
+    s.fetchHits = c.fetchHits.load(std::memory_order_relaxed);
+    s.fetchMisses = c.fetchMisses.load(std::memory_order_relaxed);
+    return s;
+}
+
 void Cache::resetStats() {
-    cacheHits = 0;
-    cacheMisses = 0;
-    ramReads = 0;
-    ramWrites = 0;
-    tags.clear();
-    tags.assign(static_cast<size_t>(numSets), std::map<int, CacheLineInfo>{});
-    dirty.clear();
-    dirty.assign(static_cast<size_t>(numSets), std::vector<char>(static_cast<size_t>(ways), 0));
+    lines.assign(lines.size(), CacheLineInfo{});
+    dram->reset(); // before init(), which restarts the gating integrals at cycle 0
     init();
 }
 
 
 void Cache::init() {
-    int numCores = CPU::getInstance()->getNumCores();
+    // Only written when it changes: the monitor may be reading it
+    const int cores = CPU::getInstance()->getNumCores();
+    if (numCores != cores) numCores = cores;
+    if (numCores > 32) throw std::runtime_error("Sharer bitmaps support at most 32 cores");
     lastWrite.clear();
-    lastWrite.resize(static_cast<size_t>(numSets), std::vector<int>(static_cast<size_t>(numCores), -1));
-
-    int waysPerCore = ways / numCores;
-    if (partitioningEnabled) {
-        for (int s = 0; s < numSets; ++s) {
-            for (int c = 0; c < numCores; ++c)
-                lastWrite[s][c] = c * waysPerCore - 1;
-        }
+    lastWrite.resize(static_cast<size_t>(numSets), std::vector<int>(static_cast<size_t>(numCores) * 2, -1));
+    // Zero in place when possible so concurrent snapshot readers never see
+    // the vector reallocated underneath them
+    if (counters.size() != static_cast<size_t>(numCores)) {
+        counters = std::vector<CoreCounters>(static_cast<size_t>(numCores));
+        warmCounters = std::vector<CoreCounters>(static_cast<size_t>(numCores));
+        wayMasks = std::vector<std::atomic<unsigned>>(static_cast<size_t>(numCores));
     } else {
-        for (int s = 0; s < numSets; ++s) {
-            for (int c = 0; c < numCores; ++c)
-                lastWrite[s][c] = -1;
+        for (auto* group : {&counters, &warmCounters}) {
+            for (CoreCounters& c : *group) {
+                for (auto field : {&CoreCounters::hits, &CoreCounters::misses, &CoreCounters::ramReads,
+                                   &CoreCounters::ramWrites, &CoreCounters::lines, &CoreCounters::splitAccesses,
+                                   &CoreCounters::fetchHits, &CoreCounters::fetchMisses,
+                                   &CoreCounters::invalidations, &CoreCounters::upgrades,
+                                   &CoreCounters::coherenceMessages, &CoreCounters::bypassed})
+                    (c.*field).store(0, std::memory_order_relaxed);
+            }
         }
     }
+    samplers = std::vector<SamplerState>(static_cast<size_t>(numCores));
+    for (SetSample& ss : setSamples) {
+        ss.hits.store(0, std::memory_order_relaxed);
+        ss.accesses.store(0, std::memory_order_relaxed);
+    }
+
     ram = RAM::getInstance();
+    dram = DRAM::getInstance();
+
+    {
+        std::lock_guard<std::mutex> guard(gatingLock);
+        activeMask = allWays();
+        gateEvents = wakeEvents = 0;
+        activeWayAccesses = 0.0;
+        accessesAtUpdate = 0;
+        activeWayCycles = 0.0;
+        cyclesAtUpdate = 0;
+        gatingWritebacks.store(0, std::memory_order_relaxed);
+    }
+    updateGating();
 }
 
-int Cache::get(int addr, int coreId) {
+// Accesses count consecutive bytes within the line holding addr; one tag
+// lookup (and at most one fill) covers the whole range.
+void Cache::accessImpl(int addr, int* data, int count, int coreId, bool write, AccessKind kind) {
     if (numSets == 0) throw std::runtime_error("Cache not initialized");
 
-    int blockNum = addr / BLOCK_SIZE;
-    int setIndex = blockNum % numSets;
-    int tag = blockNum / numSets;
+    int blockNum = geom.block(addr);
+    int setIndex = geom.setOf(blockNum);
+    int tag = geom.tagOf(blockNum);
+
+    if (sampling.setStride > 1 && setIndex % sampling.setStride != 0) {
+        bypass(addr, data, count, coreId, write, setIndex);
+        return;
+    }
+    const bool detailed = sampling.warmLength == 0 || inWindow(coreId);
+    if (detailed) dram->advance(coreId, HIT_CYCLES);
 
-    std::lock_guard<std::mutex> lock(setLocks[setIndex]);
+    if (!write && concurrencyMode == ConcurrencyMode::OPTIMISTIC &&
+        tryOptimisticRead(addr, data, count, setIndex, tag, coreId, kind, detailed))
+        return;
+    if (!detailed) {
+        warm(addr, data, count, coreId, write, kind, setIndex, tag);
+        return;
+    }
 
-    auto it = tags[setIndex].find(tag);
-    if (it == tags[setIndex].end() ||
-        (!partitioningEnabled && tags[setIndex][tag].ownerCore != coreId)) {
-        cacheMisses++;
-        copyBlockUnlocked(blockNum, coreId); // no re-lock
-        it = tags[setIndex].find(tag);
-        if (it == tags[setIndex].end())
-            throw std::runtime_error("[Cache::get] Miss handling failed");
+    SetLock& sl = setLocks[setIndex];
+    std::lock_guard<std::mutex> lock(sl.mutex);
+    SeqWriteScope seq(sl.version);
+
+    CacheLineInfo* set = &lines[static_cast<size_t>(setIndex) * ways];
+    int way = -1;
+    for (int w = 0; w < ways; ++w) {
+        if (set[w].tag == tag) { way = w; break; }
+    }
+
+    CoreCounters& cc = counters[coreId];
+    if (sampling.setStride > 1 && kind == AccessKind::DATA) {
+        setSamples[setIndex].accesses.fetch_add(1, std::memory_order_relaxed);
+        if (way != -1) setSamples[setIndex].hits.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (way == -1) {
+        bump(kind == AccessKind::CODE ? cc.fetchMisses : cc.misses);
+        copyBlockUnlocked(blockNum, coreId, kind); // no re-lock
+        way = -1;
+        for (int w = 0; w < ways; ++w) {
+            if (set[w].tag == tag) { way = w; break; }
+        }
+        if (way == -1)
+            throw std::runtime_error(write ? "[Cache::set] Miss handling failed"
+                                           : "[Cache::get] Miss handling failed");
     } else {
-        cacheHits++;
+        bump(kind == AccessKind::CODE ? cc.fetchHits : cc.hits);
     }
+    applyCoherence(set[way], cc, coreId, write);
 
-    int way = it->second.wayIndex;
-    return mem[(way * numSets + setIndex) * BLOCK_SIZE + (addr % BLOCK_SIZE)];
+    RelaxedAtomic<int>* line = &mem[static_cast<size_t>((way * numSets + setIndex) * BLOCK_SIZE + geom.offset(addr))];
+    if (write) {
+        std::copy(data, data + count, line);
+        set[way].dirty = true;
+    } else {
+        std::copy(line, line + count, data);
+    }
 }
 
-void Cache::set(int addr, int val, int coreId) {
-    if (numSets == 0) throw std::runtime_error("Cache not initialized");
+// Lock-free hit path. Lines and data may be read while a fill is rewriting
+// them; the version check discards any such torn read. Returns false on a
+// miss or after repeated races, and the caller takes the locked path.
+bool Cache::tryOptimisticRead(int addr, int* data, int count, int setIndex, int tag, int coreId,
+                              AccessKind kind, bool detailed) {
+    const SetLock& sl = setLocks[setIndex];
+    const CacheLineInfo* set = &lines[static_cast<size_t>(setIndex) * ways];
+
+    for (int attempt = 0; attempt < MAX_OPTIMISTIC_RETRIES; ++attempt) {
+        unsigned before = sl.version.load(std::memory_order_acquire);
+        if (before & 1u) continue; // writer in progress
+
+        int way = -1;
+        for (int w = 0; w < ways; ++w) {
+            if (set[w].tag == tag) { way = w; break; }
+        }
+        // Only a read by a core already in the sharer set leaves the line
+        // untouched; warming does not track sharers, so any hit will do
+        bool hit = way != -1 && (!detailed || (set[way].sharers & (1u << coreId)));
+        if (hit) {
+            const RelaxedAtomic<int>* line = &mem[static_cast<size_t>((way * numSets + setIndex) * BLOCK_SIZE + geom.offset(addr))];
+            std::copy(line, line + count, data);
+        }
 
-    int blockNum = addr / BLOCK_SIZE;
-    int setIndex = blockNum % numSets;
-    int tag = blockNum / numSets;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sl.version.load(std::memory_order_relaxed) != before) continue;
 
-    std::lock_guard<std::mutex> lock(setLocks[setIndex]);
+        if (!hit) return false;
+        CoreCounters& cc = detailed ? counters[coreId] : warmCounters[coreId];
+        bump(kind == AccessKind::CODE ? cc.fetchHits : cc.hits);
+        if (detailed && sampling.setStride > 1 && kind == AccessKind::DATA) {
+            setSamples[setIndex].accesses.fetch_add(1, std::memory_order_relaxed);
+            setSamples[setIndex].hits.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+    return false;
+}
 
-    auto it = tags[setIndex].find(tag);
-    if (it == tags[setIndex].end() ||
-        (!partitioningEnabled && tags[setIndex][tag].ownerCore != coreId)) {
-        cacheMisses++;
-        copyBlockUnlocked(blockNum, coreId); // no re-lock
-        it = tags[setIndex].find(tag);
-        if (it == tags[setIndex].end())
-            throw std::runtime_error("[Cache::set] Miss handling failed");
+// Functional warming: tags, replacement state and data only. Coherence
+// state, stats (beyond the access count) and the DRAM model are skipped,
+// and read hits never take the set lock (see tryOptimisticRead). Fills
+// still copy the block: serving warmed lines from RAM instead would put
+// every later read of them under the set lock, which costs more.
+void Cache::warm(int addr, int* data, int count, int coreId, bool write, AccessKind kind, int setIndex, int tag) {
+    SetLock& sl = setLocks[setIndex];
+    std::lock_guard<std::mutex> lock(sl.mutex);
+    SeqWriteScope seq(sl.version);
+
+    CacheLineInfo* set = &lines[static_cast<size_t>(setIndex) * ways];
+    int way = -1;
+    for (int w = 0; w < ways; ++w) {
+        if (set[w].tag == tag) { way = w; break; }
+    }
+    CoreCounters& cc = warmCounters[coreId];
+    if (way == -1) {
+        bump(kind == AccessKind::CODE ? cc.fetchMisses : cc.misses);
+        way = copyBlockUnlocked(geom.block(addr), coreId, kind, false);
     } else {
-        cacheHits++;
+        bump(kind == AccessKind::CODE ? cc.fetchHits : cc.hits);
     }
+    if (data == nullptr) return; // fetch
 
-    int way = it->second.wayIndex;
-    mem[(way * numSets + setIndex) * BLOCK_SIZE + (addr % BLOCK_SIZE)] = val;
-    dirty[setIndex][way] = true;
+    RelaxedAtomic<int>* line = &mem[static_cast<size_t>((way * numSets + setIndex) * BLOCK_SIZE + geom.offset(addr))];
+    if (write) {
+        std::copy(data, data + count, line);
+        set[way].dirty = true;
+    } else {
+        std::copy(line, line + count, data);
+    }
+}
+
+// Splits [addr, addr + count) at line boundaries; each touched line is a
+// single cache access.
+void Cache::accessRange(int addr, int* data, int count, int coreId, bool write) {
+    if (count <= 0) return;
+    if (addr / BLOCK_SIZE != (addr + count - 1) / BLOCK_SIZE)
+        bump(counters[coreId].splitAccesses);
+
+    while (count > 0) {
+        int chunk = std::min(count, BLOCK_SIZE - addr % BLOCK_SIZE);
+        accessImpl(addr, data, chunk, coreId, write, AccessKind::DATA);
+        addr += chunk;
+        data += chunk;
+        count -= chunk;
+    }
+    if (epochLength > 0) tick();
 }
 
 void Cache::copyBlock(int blockNum, int coreId) {
     // Keep public version for safety
-    int setIndex = blockNum % numSets;
-    std::lock_guard<std::mutex> lock(setLocks[setIndex]);
+    int setIndex = geom.setOf(blockNum);
+    SetLock& sl = setLocks[setIndex];
+    std::lock_guard<std::mutex> lock(sl.mutex);
+    SeqWriteScope seq(sl.version);
+
+    // Already resident: a second copy would duplicate the tag.
+    // Unsampled sets never hold lines.
+    if (sampling.setStride > 1 && setIndex % sampling.setStride != 0) return;
+    const CacheLineInfo* set = &lines[static_cast<size_t>(setIndex) * ways];
+    for (int w = 0; w < ways; ++w) {
+        if (set[w].tag == geom.tagOf(blockNum)) return;
+    }
     copyBlockUnlocked(blockNum, coreId);
 }
 
-void Cache::copyBlockUnlocked(int blockNum, int coreId) {
-    int setIndex = blockNum % numSets;
+void Cache::setWayMask(int coreId, unsigned mask) {
+    if (coreId < 0 || coreId >= numCores)
+        throw std::runtime_error("Invalid core id " + std::to_string(coreId));
+    if (mask != 0) {
+        if (ways > 32 || (ways < 32 && (mask >> ways) != 0))
+            throw std::runtime_error("Way mask exceeds associativity");
+        unsigned low = mask & (~mask + 1u);
+        if (((mask + low) & mask) != 0)
+            throw std::runtime_error("Way mask must be contiguous");
+    }
+    wayMasks[coreId].store(mask, std::memory_order_relaxed);
+    updateGating();
+}
 
-    int targetWay;
-    if (partitioningEnabled) {
-        int waysPerCore = ways / CPU::getInstance()->getNumCores();
-        lastWrite[setIndex][coreId]++;
-        int partitionStart = coreId * waysPerCore;
-        if (lastWrite[setIndex][coreId] - partitionStart >= waysPerCore)
-            lastWrite[setIndex][coreId] = partitionStart;
-        targetWay = lastWrite[setIndex][coreId];
-    } else {
-        lastWrite[setIndex][coreId]++;
-        if (lastWrite[setIndex][coreId] >= ways) lastWrite[setIndex][coreId] = 0;
-        targetWay = lastWrite[setIndex][coreId];
+// Validates every mask before applying any, then gates once, so moving a
+// way between two cores does not switch it off and on again
+void Cache::setWayMasks(const std::vector<unsigned>& masks) {
+    if (masks.size() != static_cast<size_t>(numCores))
+        throw std::runtime_error("Expected one way mask per core");
+    for (unsigned mask : masks) {
+        if (mask == 0) continue;
+        if (ways > 32 || (ways < 32 && (mask >> ways) != 0))
+            throw std::runtime_error("Way mask exceeds associativity");
+        unsigned low = mask & (~mask + 1u);
+        if (((mask + low) & mask) != 0)
+            throw std::runtime_error("Way mask must be contiguous");
     }
+    for (size_t c = 0; c < masks.size(); ++c)
+        wayMasks[c].store(masks[c], std::memory_order_relaxed);
+    updateGating();
+}
 
-    int newTag = blockNum / numSets;
+// Effective allocation of coreId under the current mode
+unsigned Cache::getWayMask(int coreId) const {
+    if (!partitioningEnabled) return allWays();
+    unsigned mask = wayMasks[coreId].load(std::memory_order_relaxed);
+    if (mask != 0) return mask;
+    int waysPerCore = ways / numCores;
+    return lowWays(waysPerCore) << (coreId * waysPerCore);
+}
 
-    // Evict old line
-    int oldTag = -1;
-    for (auto it = tags[setIndex].begin(); it != tags[setIndex].end(); ++it) {
-        if (it->second.wayIndex == targetWay) {
-            oldTag = it->first;
-            tags[setIndex].erase(it);
-            break;
+void Cache::resetWayMasks() {
+    for (auto& m : wayMasks) m.store(0, std::memory_order_relaxed);
+    updateGating();
+}
+
+void Cache::setPartitioning(bool enable) {
+    partitioningEnabled = enable;
+    updateGating();
+}
+
+void Cache::setCodeWays(int n) {
+    if (n < 0 || (n > 0 && numCores > 0 && n >= ways / numCores))
+        throw std::runtime_error("Code ways must be smaller than the per-core partition (" +
+                                 std::to_string(numCores > 0 ? ways / numCores : ways) + " ways)");
+    codeWays = n;
+}
+
+void Cache::setPowerGating(bool enable) {
+    powerGating = enable;
+    updateGating();
+}
+
+long long Cache::totalAccesses() const {
+    return sum(counters, &CoreCounters::hits) + sum(counters, &CoreCounters::misses)
+         + sum(counters, &CoreCounters::fetchHits) + sum(counters, &CoreCounters::fetchMisses);
+}
+
+long long Cache::simulatedCycles() const {
+    long long latest = 0;
+    for (int c = 0; c < numCores; ++c) latest = std::max(latest, dram->getCycles(c));
+    return latest;
+}
+
+// Recomputes the powered ways from the current masks. Ways that go dark are
+// flushed; ways that come back start empty.
+void Cache::updateGating() {
+    if (numCores == 0) return; // before init()
+    std::lock_guard<std::mutex> guard(gatingLock);
+
+    unsigned target = allWays();
+    if (powerGating && partitioningEnabled) {
+        target = 0;
+        for (int c = 0; c < numCores; ++c) target |= getWayMask(c);
+    }
+
+    const double active = static_cast<double>(std::bitset<32>(activeMask).count());
+    const long long now = totalAccesses();
+    activeWayAccesses += active * static_cast<double>(now - accessesAtUpdate);
+    accessesAtUpdate = now;
+    const long long cycles = simulatedCycles();
+    activeWayCycles += active * static_cast<double>(cycles - cyclesAtUpdate);
+    cyclesAtUpdate = cycles;
+    if (target == activeMask) return;
+
+    const unsigned gated = activeMask & ~target;
+    gateEvents += static_cast<long long>(std::bitset<32>(gated).count());
+    wakeEvents += static_cast<long long>(std::bitset<32>(target & ~activeMask).count());
+    if (gated) flushWays(gated);
+    activeMask = target;
+}
+
+// Writes back and invalidates every line in the given ways
+void Cache::flushWays(unsigned mask) {
+    for (int setIndex = 0; setIndex < numSets; ++setIndex)
+        flushSet(setIndex, mask);
+}
+
+void Cache::flushSet(int setIndex, unsigned mask) {
+    SetLock& sl = setLocks[setIndex];
+    std::lock_guard<std::mutex> lock(sl.mutex);
+    SeqWriteScope seq(sl.version);
+
+    CacheLineInfo* set = &lines[static_cast<size_t>(setIndex) * ways];
+    for (int w = 0; w < ways; ++w) {
+        if (!(mask & (1u << w)) || set[w].tag == -1) continue;
+        if (set[w].dirty) {
+            int blockNum = set[w].tag * numSets + setIndex;
+            size_t startAddr = (w * numSets + setIndex) * BLOCK_SIZE;
+            for (int i = 0; i < BLOCK_SIZE; ++i)
+                ram->mem[blockNum * BLOCK_SIZE + i] = mem[startAddr + i];
+            gatingWritebacks.fetch_add(BLOCK_SIZE, std::memory_order_relaxed);
+            dram->access(blockNum, std::max(set[w].ownerCore, 0), true);
         }
+        if (set[w].ownerCore >= 0)
+            counters[set[w].ownerCore].lines.fetch_sub(1, std::memory_order_relaxed);
+        set[w] = CacheLineInfo{};
     }
+}
+
+double Cache::getAverageActiveWays() {
+    std::lock_guard<std::mutex> guard(gatingLock);
+    const long long now = totalAccesses();
+    const double active = static_cast<double>(std::bitset<32>(activeMask).count());
+    if (now == 0) return active;
+    return (activeWayAccesses + active * static_cast<double>(now - accessesAtUpdate)) / static_cast<double>(now);
+}
+
+double Cache::getActiveWayCycles() {
+    std::lock_guard<std::mutex> guard(gatingLock);
+    const double active = static_cast<double>(std::bitset<32>(activeMask).count());
+    return activeWayCycles + active * static_cast<double>(simulatedCycles() - cyclesAtUpdate);
+}
+
+void Cache::setEpochListener(long long epochAccesses, std::function<void()> listener) {
+    if (epochAccesses <= 0) throw std::runtime_error("Epoch length must be positive");
+    epochListener = std::move(listener);
+    epochClock.store(0, std::memory_order_relaxed);
+    epochLength = epochAccesses;
+}
+
+void Cache::clearEpochListener() {
+    epochLength = 0;
+    epochListener = nullptr;
+}
+
+void Cache::tick() {
+    long long n = epochClock.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (n % epochLength == 0) {
+        std::lock_guard<std::mutex> guard(epochLock);
+        epochListener();
+    }
+}
+
+// MESI transition for an access by coreId to a resident line. A fresh
+// fill arrives as EXCLUSIVE with coreId as the only sharer.
+void Cache::applyCoherence(CacheLineInfo& line, CoreCounters& cc, int coreId, bool write) {
+    const unsigned self = 1u << coreId;
+    const unsigned others = line.sharers & ~self;
 
-    if (oldTag != -1 && dirty[setIndex][targetWay]) {
-        int evictedBlockNum = oldTag * numSets + setIndex;
+    if (write) {
+        if (others) {
+            const long long n = static_cast<long long>(std::bitset<32>(others).count());
+            bump(cc.invalidations, n);
+            bump(cc.coherenceMessages, n);
+        }
+        if (line.state == LineState::SHARED && (line.sharers & self)) {
+            bump(cc.upgrades);
+            bump(cc.coherenceMessages);
+        }
+        line.sharers = self;
+        line.state = LineState::MODIFIED;
+    } else if (!(line.sharers & self)) {
+        // Another core holds it exclusively: it is downgraded to SHARED
+        if (line.state == LineState::MODIFIED || line.state == LineState::EXCLUSIVE)
+            bump(cc.coherenceMessages);
+        line.sharers |= self;
+        line.state = LineState::SHARED;
+    }
+}
+
+// Ways [lo, hi) a core may fill for the given access kind. With
+// partitioning each core owns its way mask, by default ways / numCores
+// contiguous ways; with CDP (codeWays > 0) the first codeWays of them hold
+// code and the rest data. A way mask (QoS) narrower than codeWays + 1
+// leaves code and data sharing the whole mask.
+void Cache::wayRange(int coreId, AccessKind kind, int& lo, int& hi) const {
+    if (!partitioningEnabled) {
+        lo = 0;
+        hi = ways;
+        return;
+    }
+    unsigned mask = wayMasks[coreId].load(std::memory_order_relaxed);
+    if (mask != 0) {
+        lo = 0;
+        while (!(mask & (1u << lo))) lo++;
+        hi = lo;
+        while (hi < ways && (mask & (1u << hi))) hi++;
+    } else {
+        lo = coreId * (ways / numCores);
+        hi = lo + ways / numCores;
+    }
+    if (codeWays > 0 && codeWays < hi - lo) {
+        if (kind == AccessKind::CODE) hi = lo + codeWays;
+        else lo += codeWays;
+    }
+}
+
+// Fills blockNum into coreId's next way and returns it. A warming fill
+// (!detailed) moves the data but skips the DRAM model.
+int Cache::copyBlockUnlocked(int blockNum, int coreId, AccessKind kind, bool detailed) {
+    int setIndex = geom.setOf(blockNum);
+    CoreCounters& cc = detailed ? counters[coreId] : warmCounters[coreId];
+
+    // Round-robin within the allowed ways, one pointer per core and kind
+    int lo, hi;
+    wayRange(coreId, kind, lo, hi);
+    int& last = lastWrite[setIndex][coreId * 2 + static_cast<int>(kind)];
+    last++;
+    if (last < lo || last >= hi) last = lo;
+    int targetWay = last;
+
+    int newTag = geom.tagOf(blockNum);
+    CacheLineInfo* set = &lines[static_cast<size_t>(setIndex) * ways];
+
+    // Evict old line
+    CacheLineInfo& victim = set[targetWay];
+    if (victim.tag != -1 && victim.dirty) {
+        int evictedBlockNum = victim.tag * numSets + setIndex;
         size_t startAddr = (targetWay * numSets + setIndex) * BLOCK_SIZE;
         for (int i = 0; i < BLOCK_SIZE; ++i)
             ram->mem[evictedBlockNum * BLOCK_SIZE + i] = mem[startAddr + i];
-        dirty[setIndex][targetWay] = 0;
-        ramWrites += BLOCK_SIZE;
+        bump(cc.ramWrites, BLOCK_SIZE);
+        if (detailed) dram->access(evictedBlockNum, coreId, true);
     }
 
-    tags[setIndex][newTag] = {targetWay, coreId};
+    // The shared cache is the only level, so there are no private copies
+    // to back-invalidate: an eviction just drops the line and its sharers
+    if (victim.tag != -1 && victim.ownerCore >= 0)
+        counters[victim.ownerCore].lines.fetch_sub(1, std::memory_order_relaxed);
+    victim = {newTag, coreId, false, LineState::EXCLUSIVE, 1u << coreId};
+    counters[coreId].lines.fetch_add(1, std::memory_order_relaxed);
 
     size_t startAddrMem = (targetWay * numSets + setIndex) * BLOCK_SIZE;
     for (int i = 0; i < BLOCK_SIZE; ++i) {
         mem[startAddrMem + i] = ram->mem[blockNum * BLOCK_SIZE + i];
     }
-    dirty[setIndex][targetWay] = 0;
-    ramReads += BLOCK_SIZE;
+    bump(cc.ramReads, BLOCK_SIZE);
+    if (detailed) dram->access(blockNum, coreId, false);
+    return targetWay;
+}
+
+void Cache::setSampling(const SamplingConfig& cfg) {
+    if (cfg.setStride < 1 || cfg.setStride > numSets)
+        throw std::runtime_error("Set sampling stride must be between 1 and the number of sets");
+    if (cfg.warmLength < 0 || cfg.windowLength <= 0)
+        throw std::runtime_error("Invalid sampling window");
+    sampling = cfg;
+    for (int setIndex = 0; setIndex < numSets; ++setIndex) {
+        if (setIndex % sampling.setStride != 0) flushSet(setIndex, allWays());
+        setSamples[setIndex].hits.store(0, std::memory_order_relaxed);
+        setSamples[setIndex].accesses.store(0, std::memory_order_relaxed);
+    }
+    samplers = std::vector<SamplerState>(samplers.size());
+}
+
+// Advances coreId's sampling clock; true inside a detailed window. Each
+// window's hits and accesses are read off the counters when the next
+// warming phase starts, since only detailed accesses reach them.
+bool Cache::inWindow(int coreId) {
+    SamplerState& s = samplers[coreId];
+    const long long phase = s.phase;
+    if (++s.phase == sampling.warmLength + sampling.windowLength) s.phase = 0; // no division per access
+    if (phase == 0 && s.started) {
+        const CoreCounters& c = counters[coreId];
+        const long long hits = c.hits.load(std::memory_order_relaxed);
+        const long long accesses = hits + c.misses.load(std::memory_order_relaxed);
+        if (accesses > s.lastAccesses) s.windows.push_back({hits - s.lastHits, accesses - s.lastAccesses});
+        s.lastHits = hits;
+        s.lastAccesses = accesses;
+    }
+    s.started = true;
+    return phase >= sampling.warmLength;
+}
+
+// Unsampled sets are never cached: the access goes straight to RAM
+void Cache::bypass(int addr, int* data, int count, int coreId, bool write, int setIndex) {
+    if (data == nullptr) return; // fetch
+    bump(counters[coreId].bypassed);
+    // RAM words of a block are only touched under its set's lock
+    std::lock_guard<std::mutex> lock(setLocks[setIndex].mutex);
+    int* target = &ram->mem[static_cast<size_t>(addr)];
+    if (write) std::copy(data, data + count, target);
+    else std::copy(target, target + count, data);
+}
+
+std::vector<SampleUnit> Cache::getSetSamples() const {
+    std::vector<SampleUnit> units;
+    for (int setIndex = 0; setIndex < numSets; setIndex += sampling.setStride) {
+        const SetSample& ss = setSamples[setIndex];
+        units.push_back({ss.hits.load(std::memory_order_relaxed), ss.accesses.load(std::memory_order_relaxed)});
+    }
+    return units;
+}
+
+// Closed windows plus the one still open, if it saw any data accesses
+std::vector<SampleUnit> Cache::getWindowSamples() const {
+    std::vector<SampleUnit> units;
+    for (size_t c = 0; c < samplers.size(); ++c) {
+        const SamplerState& s = samplers[c];
+        units.insert(units.end(), s.windows.begin(), s.windows.end());
+        const long long hits = counters[c].hits.load(std::memory_order_relaxed);
+        const long long accesses = hits + counters[c].misses.load(std::memory_order_relaxed);
+        if (accesses > s.lastAccesses) units.push_back({hits - s.lastHits, accesses - s.lastAccesses});
+    }
+    return units;
 }
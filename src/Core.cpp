@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <stdexcept>
 #include <unistd.h>
 #include "Constants.h"
@@ -11,6 +12,15 @@
 
 RAM* Core::ram = nullptr;
 Cache* Core::cache = nullptr;
+FetchMode Core::fetchMode = FetchMode::UNIFIED;
+int Core::icacheBlocks = 8;
+int Core::icacheWays = 2;
+
+void Core::setFetchMode(FetchMode mode, int blocks, int ways) {
+  fetchMode = mode;
+  icacheBlocks = blocks;
+  icacheWays = ways;
+}
 
 Core::Core(int i) : id(i) {
   ram = RAM::getInstance();
@@ -37,6 +47,45 @@ void Core::store(int addr) {
 
 void Core::set(char val) { acc = val; }
 
+void Core::checkRange(int addr, int count) const {
+    if (addr < 0 || count < 0 || addr + count > ram->getSize())
+        throw std::runtime_error("Invalid memory access at " + std::to_string(addr)
+                                 + " (" + std::to_string(count) + " bytes)");
+}
+
+// Wide and bulk accesses stage their bytes in fixed buffers on the stack;
+// the cache moves each touched line in one lookup
+void Core::loadWide(int addr, int width) {
+    checkRange(addr, width);
+    std::array<int, 32> bytes;
+    cache->read(addr, bytes.data(), width, id);
+    for (int i = 0; i < width / 4; i++)
+        wide[i] = loadBytes(bytes.data() + i * 4, 4);
+}
+
+void Core::storeWide(int addr, int width) {
+    checkRange(addr, width);
+    std::array<int, 32> bytes;
+    for (int i = 0; i < width / 4; i++)
+        storeBytes(bytes.data() + i * 4, wide[i], 4);
+    cache->write(addr, bytes.data(), width, id);
+}
+
+void Core::copyBytes(int dst, int src, int len) {
+    checkRange(src, len);
+    checkRange(dst, len);
+    int bytes[BULK_MAX_LEN];
+    cache->read(src, bytes, len, id);
+    cache->write(dst, bytes, len, id);
+}
+
+void Core::fillBytes(int dst, int len) {
+    checkRange(dst, len);
+    int bytes[BULK_MAX_LEN];
+    std::fill(bytes, bytes + len, static_cast<int>(acc));
+    cache->write(dst, bytes, len, id);
+}
+
 void Core::runInstruction() {
   // const std::string ops[] = {"LOAD", "STORE", "EXECUTE"};
   // std::cout << (ops[static_cast<int>(ir.op)]) << " " << std::hex << ir.operand << std::dec << std::endl;
@@ -53,14 +102,61 @@ void Core::runInstruction() {
     case Operator::EXECUTE:
       usleep(100); // Simulate execution time
       break;
+    case Operator::LOAD4:
+    case Operator::LOAD8:
+    case Operator::LOAD16:
+    case Operator::LOAD32:
+      loadWide(dataAddr + ir.operand, ir.width());
+      break;
+    case Operator::STORE4:
+    case Operator::STORE8:
+    case Operator::STORE16:
+    case Operator::STORE32:
+      storeWide(dataAddr + ir.operand, ir.width());
+      break;
+    case Operator::MEMCPY:
+      copyBytes(dataAddr + ir.bulkDst(), dataAddr + ir.bulkSrc(), ir.bulkLen());
+      break;
+    case Operator::MEMSET:
+      fillBytes(dataAddr + ir.bulkDst(), ir.bulkLen());
+      break;
     default:
       throw std::runtime_error("Unknown instruction" + std::to_string(static_cast<int>(ir.op)));
   }
 }
 
+// Decode the loaded image once; the interpreter then indexes this array
+void Core::decode(int addr, int count) {
+  code.resize(static_cast<size_t>(count));
+  for (int i = 0; i < count; i++) {
+    code[i].op = static_cast<Operator>(ram->mem[addr + i * 2]);
+    code[i].operand = ram->mem[addr + i * 2 + 1];
+  }
+}
+
+// Model the fetch of the line holding addr. A fetch buffer keeps the
+// current line, so only crossing into a new line reaches the cache.
+void Core::fetch(int addr) {
+  int block = addr / BLOCK_SIZE;
+  if (block == fetchBlock) return;
+  fetchBlock = block;
+
+  switch (fetchMode) {
+    case FetchMode::SPLIT:
+      icache.fetch(addr, id);
+      break;
+    case FetchMode::UNIFIED:
+      cache->fetch(addr, id);
+      break;
+    case FetchMode::BYPASS:
+      break;
+  }
+}
+
 void Core::loadIR() {
-  ir.op = static_cast<Operator>(ram->mem[pc++]);
-  ir.operand = ram->mem[pc++];
+  fetch(pc);
+  ir = code[(pc - codeAddr) / 2];
+  pc += 2;
 }
 
 std::thread Core::runProcess(Process& p) {
@@ -76,7 +172,10 @@ std::thread Core::runProcess(Process& p) {
     busy = true;
     auto addr = procCopy.getAddr();
     auto instrCount = procCopy.instructionsCount();
-    pc = addr;
+    decode(addr, instrCount);
+    icache = ICache(icacheBlocks, icacheWays);
+    codeAddr = pc = addr;
+    fetchBlock = -1;
     acc = 0;
     for (int i = 0; i < instrCount; i++) {
       loadIR();
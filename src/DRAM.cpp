@@ -0,0 +1,207 @@
+#include "DRAM.h"
+#include "Constants.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+DRAM::DRAM(const DRAMConfig& c, int numCores) : cfg(c) {
+  if (cfg.channels <= 0 || cfg.ranks <= 0 || cfg.banks <= 0 || cfg.rowBlocks <= 0 || cfg.queueDepth <= 0)
+    throw std::runtime_error("Invalid DRAM config");
+  if (numCores <= 0) throw std::runtime_error("Invalid DRAM core count");
+  banks.assign(static_cast<size_t>(cfg.channels * cfg.ranks * cfg.banks), Bank{});
+  busFreeAt.assign(static_cast<size_t>(cfg.channels), 0);
+  coreStats.assign(static_cast<size_t>(numCores), CoreStats{});
+  clocks = std::vector<CoreClock>(static_cast<size_t>(numCores));
+}
+
+DRAM* DRAM::createInstance(const DRAMConfig& c, int numCores) {
+  instance = std::unique_ptr<DRAM>(new DRAM(c, numCores));
+  return instance.get();
+}
+
+// Block address mapping: row : rank : bank : channel : column
+void DRAM::decode(int blockNum, int& bankIndex, int& channel, int& row) const {
+  int rest = blockNum / cfg.rowBlocks;
+  channel = rest % cfg.channels;
+  rest /= cfg.channels;
+  int bank = rest % cfg.banks;
+  rest /= cfg.banks;
+  int rank = rest % cfg.ranks;
+  row = rest / cfg.ranks;
+  bankIndex = (channel * cfg.ranks + rank) * cfg.banks + bank;
+}
+
+DRAM::CoreStats& DRAM::statsFor(int coreId) {
+  return const_cast<CoreStats&>(static_cast<const DRAM*>(this)->statsFor(coreId));
+}
+
+const DRAM::CoreStats& DRAM::statsFor(int coreId) const {
+  if (coreId < 0 || static_cast<size_t>(coreId) >= coreStats.size())
+    throw std::runtime_error("Invalid core id " + std::to_string(coreId));
+  return coreStats[static_cast<size_t>(coreId)];
+}
+
+void DRAM::access(int blockNum, int coreId, bool write) {
+  std::lock_guard<std::mutex> guard(lock);
+  CoreStats& cs = statsFor(coreId);
+  long long arrival = clocks[static_cast<size_t>(coreId)].now.load(std::memory_order_relaxed);
+  if (cs.throttle > 0.0) {
+    // Throttled cores may only inject one request per spacing interval
+    arrival = std::max(arrival, cs.nextIssue);
+    cs.nextIssue = arrival + static_cast<long long>(std::ceil(cfg.tBurst / (1.0 - cs.throttle)));
+  }
+  const long long id = nextId++;
+  queue.push_back({id, blockNum, coreId, write, arrival});
+
+  if (write) {
+    if (static_cast<int>(queue.size()) > cfg.queueDepth) {
+      long long done;
+      serviceOne(done);
+    }
+    return;
+  }
+
+  // The core waits for its fill; older requests may be scheduled first
+  while (true) {
+    long long done;
+    if (serviceOne(done).id == id) {
+      clocks[static_cast<size_t>(coreId)].now.store(done, std::memory_order_relaxed);
+      return;
+    }
+  }
+}
+
+void DRAM::setThrottle(int coreId, double level) {
+  std::lock_guard<std::mutex> guard(lock);
+  statsFor(coreId).throttle = std::clamp(level, 0.0, MAX_THROTTLE);
+}
+
+double DRAM::getThrottle(int coreId) {
+  std::lock_guard<std::mutex> guard(lock);
+  return statsFor(coreId).throttle;
+}
+
+void DRAM::drain() {
+  std::lock_guard<std::mutex> guard(lock);
+  long long done;
+  while (!queue.empty())
+    serviceOne(done);
+}
+
+// Services one request and returns it, with its completion time in done
+DRAM::Request DRAM::serviceOne(long long& done) {
+  // FR-FCFS: the oldest request (by arrival) hitting an open row, else the
+  // oldest overall
+  size_t pick = 0;
+  bool pickHit = false;
+  for (size_t i = 0; i < queue.size(); ++i) {
+    int b, ch, row;
+    decode(queue[i].blockNum, b, ch, row);
+    const bool hit = cfg.policy == PagePolicy::OPEN && banks[static_cast<size_t>(b)].openRow == row;
+    if ((hit && !pickHit) || (hit == pickHit && queue[i].arrival < queue[pick].arrival)) {
+      pick = i;
+      pickHit = hit;
+    }
+  }
+  Request req = queue[pick];
+  queue.erase(queue.begin() + static_cast<long>(pick));
+
+  int b, ch, row;
+  decode(req.blockNum, b, ch, row);
+  Bank& bank = banks[static_cast<size_t>(b)];
+  CoreStats& cs = statsFor(req.coreId);
+
+  // Core threads run unsynchronized on the host, so a request can arrive
+  // (in simulated time) before commands the bank has already issued for a
+  // core that ran ahead. It is not charged for that future occupancy.
+  const bool contended = req.arrival >= bank.busySince;
+  long long start = contended ? std::max(req.arrival, bank.readyAt) : req.arrival;
+  int latency = cfg.tCAS;
+  if (bank.openRow == row) {
+    cs.rowHits++;
+  } else {
+    cs.rowMisses++;
+    if (bank.openRow != -1) {
+      latency += cfg.tRP;
+      precharges++;
+      energy += cfg.E_precharge;
+    }
+    latency += cfg.tRCD;
+    activations++;
+    energy += cfg.E_activate;
+  }
+
+  long long& bus = busFreeAt[static_cast<size_t>(ch)];
+  done = (contended ? std::max(start + latency, bus) : start + latency) + cfg.tBurst;
+
+  if (cfg.policy == PagePolicy::CLOSED) {
+    bank.openRow = -1;
+    precharges++;
+    energy += cfg.E_precharge;
+  } else {
+    bank.openRow = row;
+  }
+  if (contended) {
+    bus = done;
+    bank.busySince = start;
+    bank.readyAt = cfg.policy == PagePolicy::CLOSED ? done + cfg.tRP : done;
+  }
+
+  if (req.write) {
+    cs.writes++;
+    energy += cfg.E_write;
+  } else {
+    cs.reads++;
+    energy += cfg.E_read;
+  }
+  cs.bytes += BLOCK_SIZE;
+  cs.latency += done - req.arrival;
+
+  elapsed = std::max(elapsed, done);
+  return req;
+}
+
+void DRAM::reset() {
+  std::lock_guard<std::mutex> guard(lock);
+  banks.assign(banks.size(), Bank{});
+  busFreeAt.assign(busFreeAt.size(), 0);
+  queue.clear();
+  coreStats.assign(coreStats.size(), CoreStats{});
+  for (CoreClock& c : clocks) c.now.store(0, std::memory_order_relaxed);
+  nextId = elapsed = 0;
+  activations = precharges = 0;
+  energy = 0.0;
+}
+
+double DRAM::getRowHitRate() const {
+  long long hits = 0, total = 0;
+  for (const CoreStats& cs : coreStats) {
+    hits += cs.rowHits;
+    total += cs.rowHits + cs.rowMisses;
+  }
+  return total > 0 ? static_cast<double>(hits) / static_cast<double>(total) : 0.0;
+}
+
+long long DRAM::getCycles(int coreId) const {
+  statsFor(coreId); // validates coreId
+  return clocks[static_cast<size_t>(coreId)].now.load(std::memory_order_relaxed);
+}
+
+long long DRAM::getElapsedCycles() const {
+  long long latest = elapsed;
+  for (const CoreClock& c : clocks) latest = std::max(latest, c.now.load(std::memory_order_relaxed));
+  return latest;
+}
+
+double DRAM::getBandwidth(int coreId) const {
+  const CoreStats& cs = statsFor(coreId);
+  const long long cycles = getCycles(coreId);
+  return cycles > 0 ? static_cast<double>(cs.bytes) / static_cast<double>(cycles) : 0.0;
+}
+
+double DRAM::getRowHitRate(int coreId) const {
+  const CoreStats& cs = statsFor(coreId);
+  long long total = cs.rowHits + cs.rowMisses;
+  return total > 0 ? static_cast<double>(cs.rowHits) / static_cast<double>(total) : 0.0;
+}
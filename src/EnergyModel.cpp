@@ -0,0 +1,23 @@
+#include "EnergyModel.h"
+#include "CacheGeometry.h"
+#include "Constants.h"
+#include <algorithm>
+#include <cmath>
+
+// Address bits left after the set index and block offset
+int EnergyModel::tagBits(int sets) {
+  int setBits = 0;
+  while ((1 << setBits) < sets) setBits++;
+  return std::max(0, SYSTEM_BITS - setBits - log2Exact(BLOCK_SIZE));
+}
+
+double EnergyModel::accessEnergy(double sizeBytes, double ways, int sets) const {
+  if (sizeBytes <= 0.0 || ways <= 0.0) return 0.0;
+  const double sizeScale = std::pow(sizeBytes / refSizeBytes, sizeExponent);
+  const double wayScale = (1.0 + wayWeight * (ways - 1.0)) / (1.0 + wayWeight * (refWays - 1.0));
+  return E_ref_access * sizeScale * wayScale + E_tag_bit * tagBits(sets) * ways;
+}
+
+double EnergyModel::leakage(double activeBytes, double cycles) const {
+  return leakagePerByteCycle * activeBytes * cycles;
+}
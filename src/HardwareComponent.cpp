@@ -2,11 +2,13 @@
 #include "CPU.h"
 #include "RAM.h"
 #include "Cache.h"
+#include "DRAM.h"
 
 
 template class HardwareComponent<CPU>;
 template class HardwareComponent<RAM>;
 template class HardwareComponent<Cache>;
+template class HardwareComponent<DRAM>;
 
 template <typename T>
 std::unique_ptr<T> HardwareComponent<T>::instance = nullptr;
@@ -0,0 +1,39 @@
+#include "ICache.h"
+#include "Constants.h"
+#include "DRAM.h"
+#include <stdexcept>
+
+ICache::ICache(int numBlocks, int w) : ways(w), numSets(0) {
+  if (numBlocks <= 0 || w <= 0) throw std::runtime_error("Invalid I-cache config");
+  if (numBlocks % w != 0) throw std::runtime_error("I-cache blocks must be divisible by ways");
+  numSets = numBlocks / w;
+  reset();
+}
+
+void ICache::reset() {
+  tags.assign(static_cast<size_t>(numSets) * static_cast<size_t>(ways), -1);
+  lastWrite.assign(static_cast<size_t>(numSets), -1);
+  hits = misses = 0;
+}
+
+bool ICache::fetch(int addr, int coreId) {
+  int blockNum = addr / BLOCK_SIZE;
+  int setIndex = blockNum % numSets;
+  int tag = blockNum / numSets;
+  DRAM::getInstance()->advance(coreId, HIT_CYCLES);
+
+  int* set = &tags[static_cast<size_t>(setIndex) * ways];
+  for (int w = 0; w < ways; ++w) {
+    if (set[w] == tag) {
+      hits++;
+      return true;
+    }
+  }
+
+  misses++;
+  int& last = lastWrite[static_cast<size_t>(setIndex)];
+  if (++last >= ways) last = 0;
+  set[last] = tag;
+  DRAM::getInstance()->access(blockNum, coreId, false); // code is never dirty
+  return false;
+}
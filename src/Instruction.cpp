@@ -1,3 +1,32 @@
 #include "Instruction.h"
 
-Instruction::Instruction(Operator o, int opd) : op(o), operand(opd) {}
\ No newline at end of file
+Instruction::Instruction(Operator o, int opd) : op(o), operand(opd) {}
+
+int Instruction::width() const {
+  switch (op) {
+    case Operator::LOAD4: case Operator::STORE4: return 4;
+    case Operator::LOAD8: case Operator::STORE8: return 8;
+    case Operator::LOAD16: case Operator::STORE16: return 16;
+    case Operator::LOAD32: case Operator::STORE32: return 32;
+    default: return 1;
+  }
+}
+
+int Instruction::bulkSrc() const {
+  return static_cast<int>(static_cast<unsigned>(operand) & (BULK_ADDR_LIMIT - 1));
+}
+
+int Instruction::bulkDst() const {
+  return static_cast<int>((static_cast<unsigned>(operand) >> BULK_ADDR_BITS) & (BULK_ADDR_LIMIT - 1));
+}
+
+int Instruction::bulkLen() const {
+  return static_cast<int>((static_cast<unsigned>(operand) >> (2 * BULK_ADDR_BITS)) & 0xFF);
+}
+
+int Instruction::bulkOperand(int dst, int src, int len) {
+  unsigned packed = (static_cast<unsigned>(len) & 0xFF) << (2 * BULK_ADDR_BITS)
+                  | (static_cast<unsigned>(dst) & (BULK_ADDR_LIMIT - 1)) << BULK_ADDR_BITS
+                  | (static_cast<unsigned>(src) & (BULK_ADDR_LIMIT - 1));
+  return static_cast<int>(packed);
+}
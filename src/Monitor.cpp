@@ -0,0 +1,118 @@
+#include "Monitor.h"
+#include <ncurses.h>
+#include <unistd.h>
+#include <algorithm>
+#include <bitset>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+const char LEVELS[] = " .:-=+*#%@";
+constexpr int NUM_LEVELS = sizeof(LEVELS) - 1;
+
+std::string sparkline(const std::deque<double>& values, double maxValue) {
+  std::string line;
+  for (double v : values) {
+    int level = maxValue > 0.0 ? static_cast<int>(v / maxValue * (NUM_LEVELS - 1) + 0.5) : 0;
+    line += LEVELS[std::clamp(level, 0, NUM_LEVELS - 1)];
+  }
+  return line;
+}
+
+double peak(const std::deque<double>& values) {
+  return values.empty() ? 0.0 : *std::max_element(values.begin(), values.end());
+}
+
+void push(std::deque<double>& values, double v) {
+  values.push_back(v);
+  if (values.size() > Monitor::HISTORY) values.pop_front();
+}
+
+}
+
+Monitor::Monitor(Cache* c, int periodMs)
+    : cache(c), numCores(c->getNumCores()), period(periodMs), history(static_cast<size_t>(numCores)) {}
+
+Monitor::~Monitor() { stop(); }
+
+bool Monitor::start() {
+  if (running || !isatty(STDOUT_FILENO)) return false;
+
+  initscr();
+  noecho();
+  curs_set(0);
+
+  startedAt = lastSample = std::chrono::steady_clock::now();
+  for (int c = 0; c < numCores; ++c)
+    history[static_cast<size_t>(c)].last = cache->getCoreSnapshot(c);
+
+  running = true;
+  ui = std::thread([this]() { loop(); });
+  return true;
+}
+
+void Monitor::stop() {
+  if (!running) return;
+  running = false;
+  if (ui.joinable()) ui.join();
+  endwin();
+}
+
+void Monitor::loop() {
+  while (running) {
+    std::this_thread::sleep_for(period);
+    sample();
+    draw();
+  }
+}
+
+void Monitor::sample() {
+  auto now = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(now - lastSample).count();
+  lastSample = now;
+  if (seconds <= 0.0) return;
+
+  for (int c = 0; c < numCores; ++c) {
+    CoreHistory& h = history[static_cast<size_t>(c)];
+    Cache::CoreSnapshot cur = cache->getCoreSnapshot(c);
+
+    // Counters drop back to zero when the cache is reset between runs
+    Cache::CoreSnapshot base = h.last;
+    if (cur.hits < base.hits || cur.misses < base.misses) base = Cache::CoreSnapshot{};
+
+    long long hits = cur.hits - base.hits;
+    long long accesses = hits + cur.misses - base.misses;
+    long long traffic = cur.ramReads - base.ramReads + cur.ramWrites - base.ramWrites;
+
+    push(h.hitRate, accesses > 0 ? static_cast<double>(hits) / static_cast<double>(accesses) : 0.0);
+    push(h.ramTraffic, static_cast<double>(traffic) / seconds);
+    push(h.accessRate, static_cast<double>(accesses) / seconds);
+    push(h.ways, static_cast<double>(std::bitset<32>(cache->getWayMask(c)).count()));
+    h.last = cur;
+  }
+}
+
+void Monitor::draw() const {
+  erase();
+  double elapsed = std::chrono::duration<double>(lastSample - startedAt).count();
+  mvprintw(0, 0, "Cache simulation monitor  |  %s  |  %d cores  |  %.1fs",
+           cache->isPartitioned() ? "partitioned" : "shared", numCores, elapsed);
+
+  int row = 2;
+  for (int c = 0; c < numCores; ++c) {
+    const CoreHistory& h = history[static_cast<size_t>(c)];
+    double hitRate = h.hitRate.empty() ? 0.0 : h.hitRate.back();
+    mvprintw(row++, 0, "Core %d  hit %6.2f%%  miss %6.2f%%  RAM %9.1f B/s  ways %5.2f  acc/s %9.0f",
+             c, hitRate * 100.0, (1.0 - hitRate) * 100.0,
+             h.ramTraffic.empty() ? 0.0 : h.ramTraffic.back(),
+             h.ways.empty() ? 0.0 : h.ways.back(),
+             h.accessRate.empty() ? 0.0 : h.accessRate.back());
+    mvprintw(row++, 2, "hit   |%s", sparkline(h.hitRate, 1.0).c_str());
+    mvprintw(row++, 2, "ram   |%s", sparkline(h.ramTraffic, peak(h.ramTraffic)).c_str());
+    mvprintw(row++, 2, "acc/s |%s", sparkline(h.accessRate, peak(h.accessRate)).c_str());
+    mvprintw(row++, 2, "ways  |%s", sparkline(h.ways, cache->getWays()).c_str());
+    row++;
+  }
+  refresh();
+}
@@ -4,6 +4,7 @@
 
 OS::OS(int cpu_cores, int ram_size, int cache_size, int cache_ways) {
   ram = RAM::createInstance(ram_size);
+  dram = DRAM::createInstance(DRAMConfig{}, cpu_cores);
   cache = Cache::createInstance(cache_size, cache_ways);
   // ensure Cache is created last to avoid dependency issues: See Core constructor
   cpu = CPU::createInstance(cpu_cores);
@@ -32,6 +33,10 @@ Cache* OS::getCache() const {
   return cache;
 }
 
+DRAM* OS::getDRAM() const {
+  return dram;
+}
+
 void OS::loadProcess(Process& p) {
   p.addr = ram->allocate(p.size());
   if (p.addr == -1)
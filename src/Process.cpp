@@ -2,6 +2,7 @@
 #include "RAM.h"
 #include "Constants.h"
 
+#include <algorithm>
 #include <random>
 #include <chrono>
 
@@ -21,21 +22,31 @@ int Process::getAddr() const { return addr; }
 
 int Process::instructionsCount() const { return instructions.size(); }
 
+void Process::seedRandom(unsigned seed) { rng.seed(seed); }
+
 Process Process::createRandom(int numInstructions, int dataSpace) {
-  std::uniform_int_distribution<int> rndOp(0, 3);
+  // Weights follow Operator order: single-byte ops dominate, each wide
+  // LOAD/STORE and bulk op is a third as likely.
+  std::discrete_distribution<int> rndOp({3, 3, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1});
+  // Bulk addresses must fit their packed operand fields
+  const int bulkSpace = std::min(dataSpace, BULK_ADDR_LIMIT);
   Process p(dataSpace);
   for (int i = 0; i < numInstructions; i++) {
-    Operator op = static_cast<Operator>(rndOp(rng));
-    int l = -1, r = -1;
-    if (op == Operator::SET) {
-      l = INT32_MIN;
-      r = INT32_MAX;
+    Instruction ins(static_cast<Operator>(rndOp(rng)), 0);
+    if (ins.width() > dataSpace) ins.op = (ins.op < Operator::STORE4) ? Operator::LOAD : Operator::STORE;
+
+    if (ins.op == Operator::SET) {
+      ins.operand = std::uniform_int_distribution<int>(INT32_MIN, INT32_MAX)(rng);
+    } else if (ins.op == Operator::MEMCPY || ins.op == Operator::MEMSET) {
+      int len = std::uniform_int_distribution<int>(1, std::min(BULK_MAX_LEN, bulkSpace))(rng);
+      std::uniform_int_distribution<int> rndAddr(0, bulkSpace - len);
+      int dst = rndAddr(rng);
+      int src = ins.op == Operator::MEMCPY ? rndAddr(rng) : 0;
+      ins.operand = Instruction::bulkOperand(dst, src, len);
     } else {
-      l = 0;
-      r = dataSpace - 1;
+      ins.operand = std::uniform_int_distribution<int>(0, dataSpace - ins.width())(rng);
     }
-    std::uniform_int_distribution<int> rndOprnd(l, r);
-    p.instructions.emplace_back(op, rndOprnd(rng));
+    p.instructions.push_back(ins);
   }
   return p;
 }
\ No newline at end of file
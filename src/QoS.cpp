@@ -0,0 +1,182 @@
+#include "QoS.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+double QoSController::CoreReport::attainment() const {
+  if (met.empty()) return 1.0;
+  return static_cast<double>(std::count(met.begin(), met.end(), true)) / static_cast<double>(met.size());
+}
+
+std::string QoSController::CoreReport::timeline(size_t width) const {
+  std::string line;
+  size_t from = met.size() > width ? met.size() - width : 0;
+  for (size_t i = from; i < met.size(); ++i)
+    line += met[i] ? '+' : '-';
+  return line;
+}
+
+QoSController::QoSController(Cache* c, DRAM* d, std::vector<QoSTarget> t, long long epoch)
+    : cache(c), dram(d), targets(std::move(t)), epochAccesses(epoch) {}
+
+void QoSController::attach() {
+  if (!cache->isPartitioned()) throw std::runtime_error("QoS needs partitioning enabled");
+
+  const int numCores = cache->getNumCores();
+  const int ways = cache->getWays();
+  if (ways > 32) throw std::runtime_error("QoS way masks support at most 32 ways");
+  if (ways < numCores) throw std::runtime_error("QoS needs at least one way per core");
+  targets.resize(static_cast<size_t>(numCores));
+
+  allocation.assign(static_cast<size_t>(numCores), ways / numCores);
+  last.clear();
+  lastCycles.clear();
+  reports.assign(static_cast<size_t>(numCores), CoreReport{});
+  for (int c = 0; c < numCores; ++c) {
+    last.push_back(cache->getCoreSnapshot(c));
+    lastCycles.push_back(dram->getCycles(c));
+    reports[static_cast<size_t>(c)].target = targets[static_cast<size_t>(c)];
+  }
+  epochs = 0;
+
+  applyAllocation();
+  cache->setEpochListener(epochAccesses, [this]() { onEpoch(); });
+}
+
+void QoSController::detach() {
+  cache->clearEpochListener();
+  cache->resetWayMasks();
+  for (size_t c = 0; c < reports.size(); ++c) {
+    reports[c].allocated = allocation[c];
+    reports[c].throttle = dram->getThrottle(static_cast<int>(c));
+    dram->setThrottle(static_cast<int>(c), 0.0);
+  }
+}
+
+void QoSController::applyAllocation() {
+  std::vector<unsigned> masks;
+  int start = 0;
+  for (int a : allocation) {
+    masks.push_back(Cache::lowWays(a) << start);
+    start += a;
+  }
+  cache->setWayMasks(masks);
+}
+
+void QoSController::onEpoch() {
+  epochs++;
+  const int numCores = static_cast<int>(allocation.size());
+  const int fairShare = cache->getWays() / numCores;
+
+  std::vector<double> missRate(static_cast<size_t>(numCores), 0.0);
+  std::vector<double> traffic(static_cast<size_t>(numCores), 0.0); // bytes per BUDGET_CYCLES
+  std::vector<bool> met(static_cast<size_t>(numCores), true);
+
+  for (int c = 0; c < numCores; ++c) {
+    const size_t i = static_cast<size_t>(c);
+    Cache::CoreSnapshot cur = cache->getCoreSnapshot(c);
+    long long misses = cur.misses - last[i].misses;
+    long long accesses = cur.hits - last[i].hits + misses;
+    const long long bytes = cur.ramReads - last[i].ramReads + cur.ramWrites - last[i].ramWrites;
+    const long long cycles = dram->getCycles(c) - lastCycles[i];
+    traffic[i] = cycles > 0 ? static_cast<double>(bytes) * BUDGET_CYCLES / static_cast<double>(cycles) : 0.0;
+    missRate[i] = accesses > 0 ? static_cast<double>(misses) / static_cast<double>(accesses) : 0.0;
+    last[i] = cur;
+    lastCycles[i] += cycles;
+
+    const QoSTarget& t = targets[i];
+    if (t.priority == Priority::LATENCY_CRITICAL)
+      met[i] = missRate[i] <= t.maxMissRate;
+    else
+      met[i] = t.bandwidthBudget == 0 || traffic[i] <= static_cast<double>(t.bandwidthBudget);
+  }
+
+  // Cache ways: feed latency-critical cores that miss their SLA
+  int unallocated = cache->getWays();
+  for (int a : allocation) unallocated -= a;
+  bool changed = false;
+
+  for (int c = 0; c < numCores; ++c) {
+    const size_t i = static_cast<size_t>(c);
+    if (targets[i].priority != Priority::LATENCY_CRITICAL) continue;
+
+    if (!met[i]) {
+      int donor = -1;
+      if (unallocated == 0) {
+        for (int d = 0; d < numCores; ++d) {
+          const size_t j = static_cast<size_t>(d);
+          if (targets[j].priority == Priority::BATCH && allocation[j] > 1 &&
+              (donor == -1 || allocation[j] > allocation[static_cast<size_t>(donor)]))
+            donor = d;
+        }
+        if (donor == -1) continue;
+        allocation[static_cast<size_t>(donor)]--;
+      } else {
+        unallocated--;
+      }
+      allocation[i]++;
+      changed = true;
+    } else if (missRate[i] < RELEASE_MARGIN * targets[i].maxMissRate && allocation[i] > fairShare) {
+      // Comfortably within SLA: return a way to the smallest batch core
+      int taker = -1;
+      for (int d = 0; d < numCores; ++d) {
+        const size_t j = static_cast<size_t>(d);
+        if (targets[j].priority == Priority::BATCH &&
+            (taker == -1 || allocation[j] < allocation[static_cast<size_t>(taker)]))
+          taker = d;
+      }
+      if (taker == -1) continue;
+      allocation[i]--;
+      allocation[static_cast<size_t>(taker)]++;
+      changed = true;
+    }
+  }
+  if (changed) applyAllocation();
+
+  // Memory bandwidth: halve a batch core's allowed share of peak while it
+  // is over budget, double it back once well under
+  for (int c = 0; c < numCores; ++c) {
+    const QoSTarget& t = targets[static_cast<size_t>(c)];
+    if (t.priority != Priority::BATCH || t.bandwidthBudget == 0) continue;
+    double level = dram->getThrottle(c);
+    if (traffic[static_cast<size_t>(c)] > static_cast<double>(t.bandwidthBudget))
+      dram->setThrottle(c, 1.0 - (1.0 - level) / THROTTLE_FACTOR);
+    else if (traffic[static_cast<size_t>(c)] < static_cast<double>(t.bandwidthBudget) / 2.0)
+      dram->setThrottle(c, level > 0.0 ? 1.0 - std::min(1.0, (1.0 - level) * THROTTLE_FACTOR) : 0.0);
+  }
+
+  for (int c = 0; c < numCores; ++c) {
+    reports[static_cast<size_t>(c)].met.push_back(met[static_cast<size_t>(c)]);
+    reports[static_cast<size_t>(c)].ways.push_back(allocation[static_cast<size_t>(c)]);
+  }
+}
+
+std::vector<QoSTarget> QoSController::parseTargets(const std::string& spec, int numCores) {
+  std::vector<QoSTarget> targets;
+  std::stringstream ss(spec);
+  std::string entry;
+  while (std::getline(ss, entry, ',')) {
+    QoSTarget t;
+    const size_t colon = entry.find(':');
+    const std::string kind = entry.substr(0, colon);
+    const std::string value = colon == std::string::npos ? "" : entry.substr(colon + 1);
+    if (kind == "lc") {
+      if (value.empty()) throw std::invalid_argument("lc needs a target miss rate, e.g. lc:0.1");
+      t.priority = Priority::LATENCY_CRITICAL;
+      t.maxMissRate = std::stod(value);
+      if (t.maxMissRate < 0.0 || t.maxMissRate > 1.0)
+        throw std::invalid_argument("lc miss rate must be between 0 and 1");
+    } else if (kind == "batch") {
+      t.priority = Priority::BATCH;
+      if (!value.empty()) t.bandwidthBudget = std::stoll(value);
+      if (t.bandwidthBudget < 0) throw std::invalid_argument("batch budget must not be negative");
+    } else {
+      throw std::invalid_argument("Unknown QoS class: " + kind);
+    }
+    targets.push_back(t);
+  }
+  if (static_cast<int>(targets.size()) > numCores)
+    throw std::invalid_argument("More QoS targets than cores");
+  targets.resize(static_cast<size_t>(numCores));
+  return targets;
+}
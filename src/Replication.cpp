@@ -0,0 +1,153 @@
+#include "Replication.h"
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Inverse standard normal CDF (Acklam's rational approximation,
+// relative error below 1.2e-9)
+double normalQuantile(double p) {
+  static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                             1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+  static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                             6.680131188771972e+01, -1.328068155288572e+01};
+  static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                             -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+  static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                             3.754408661907416e+00};
+  const double low = 0.02425;
+  if (p < low) {
+    double q = std::sqrt(-2.0 * std::log(p));
+    return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+           ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+  }
+  if (p > 1.0 - low) return -normalQuantile(1.0 - p);
+  double q = p - 0.5, r = q * q;
+  return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+         (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
+
+}
+
+// Exact for 1 and 2 degrees of freedom, Cornish-Fisher expansion in the
+// normal quantile otherwise (within 0.2% of tables from df = 3)
+double tQuantile(double confidence, long long df) {
+  const double p = 0.5 + confidence / 2.0;
+  if (df <= 0) return INFINITY;
+  if (df == 1) return std::tan(M_PI * (p - 0.5));
+  if (df == 2) return (2.0 * p - 1.0) / std::sqrt(2.0 * p * (1.0 - p));
+  const double z = normalQuantile(p), z2 = z * z, v = static_cast<double>(df);
+  const double g1 = (z2 + 1.0) * z / 4.0;
+  const double g2 = ((5.0 * z2 + 16.0) * z2 + 3.0) * z / 96.0;
+  const double g3 = (((3.0 * z2 + 19.0) * z2 + 17.0) * z2 - 15.0) * z / 384.0;
+  const double g4 = ((((79.0 * z2 + 776.0) * z2 + 1482.0) * z2 - 1920.0) * z2 - 945.0) * z / 92160.0;
+  return z + g1 / v + g2 / (v * v) + g3 / (v * v * v) + g4 / (v * v * v * v);
+}
+
+void RunningStat::add(double x) {
+  n++;
+  double delta = x - mean;
+  mean += delta / static_cast<double>(n);
+  m2 += delta * (x - mean);
+}
+
+double RunningStat::variance() const {
+  return n > 1 ? m2 / static_cast<double>(n - 1) : 0.0;
+}
+
+double RunningStat::halfWidth(double confidence) const {
+  return n > 1 ? tQuantile(confidence, n - 1) * std::sqrt(variance() / static_cast<double>(n)) : INFINITY;
+}
+
+ReplicationDriver::ReplicationDriver(const ReplicationConfig& c, std::function<TrialResult(unsigned)> t)
+    : cfg(c), trial(std::move(t)) {
+  if (cfg.jobs <= 0 || cfg.maxTrials <= 0 || cfg.minTrials < 2)
+    throw std::runtime_error("Invalid replication config");
+}
+
+bool ReplicationDriver::done(const ReplicationReport& r) const {
+  return r.trials >= cfg.minTrials
+      && 2.0 * r.hitRate.halfWidth(cfg.confidence) <= cfg.hitRateCIWidth
+      && 2.0 * r.energy.halfWidth(cfg.confidence)
+             <= std::max(cfg.energyCIWidth * std::fabs(r.energy.getMean()), cfg.energyCIFloor);
+}
+
+// Starts one trial in a child process; the result is read from fd later
+void ReplicationDriver::startTrial(unsigned seed, int& pid, int& fd) const {
+  int fds[2];
+  if (pipe(fds) != 0) throw std::runtime_error("pipe() failed");
+
+  std::cout.flush();
+  std::cerr.flush();
+  pid = fork();
+  if (pid < 0) throw std::runtime_error("fork() failed");
+
+  if (pid == 0) {
+    close(fds[0]);
+    int status = 0;
+    try {
+      TrialResult r = trial(seed);
+      if (write(fds[1], &r, sizeof r) != static_cast<ssize_t>(sizeof r)) status = 1;
+    } catch (const std::exception& e) {
+      std::cerr << "Trial " << seed << " failed: " << e.what() << "\n";
+      status = 1;
+    }
+    close(fds[1]);
+    _exit(status);
+  }
+
+  close(fds[1]);
+  fd = fds[0];
+}
+
+// Reads one trial's result and reaps its child; false if it failed
+bool ReplicationDriver::finishTrial(int pid, int fd, TrialResult& r) {
+  ssize_t got = read(fd, &r, sizeof r);
+  close(fd);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  return got == static_cast<ssize_t>(sizeof r) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+ReplicationReport ReplicationDriver::run() {
+  ReplicationReport report;
+  unsigned seed = cfg.baseSeed;
+
+  while (report.trials < cfg.maxTrials && !done(report)) {
+    int batch = std::min(cfg.jobs, cfg.maxTrials - report.trials);
+    std::vector<std::pair<int, int>> children; // (pid, fd)
+    for (int i = 0; i < batch; ++i) {
+      int pid, fd;
+      startTrial(seed++, pid, fd);
+      children.emplace_back(pid, fd);
+    }
+
+    // Collect in seed order so results do not depend on scheduling. The
+    // whole batch is reaped before a failure is reported.
+    int failedPid = 0;
+    for (auto [pid, fd] : children) {
+      TrialResult r;
+      if (!finishTrial(pid, fd, r)) {
+        if (failedPid == 0) failedPid = pid;
+        continue;
+      }
+      if (failedPid != 0) continue;
+      report.hitRate.add(r.hitRateDelta);
+      report.energy.add(r.energyDelta);
+      report.trials++;
+    }
+    if (failedPid != 0)
+      throw std::runtime_error("Replication trial (pid " + std::to_string(failedPid) + ") failed");
+  }
+
+  report.converged = done(report);
+  return report;
+}
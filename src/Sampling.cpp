@@ -0,0 +1,43 @@
+#include "Sampling.h"
+#include "Replication.h"
+#include <algorithm>
+#include <cmath>
+
+SampleEstimate estimateHitRate(const std::vector<SampleUnit>& units, double sampledFraction, double confidence) {
+  SampleEstimate e;
+  long long hits = 0;
+  for (const SampleUnit& u : units) {
+    if (u.accesses == 0) continue;
+    hits += u.hits;
+    e.sampledAccesses += u.accesses;
+    e.units++;
+  }
+  if (e.sampledAccesses == 0) {
+    e.halfWidth = INFINITY;
+    return e;
+  }
+  e.hitRate = static_cast<double>(hits) / static_cast<double>(e.sampledAccesses);
+  if (e.units < MIN_SAMPLE_UNITS) {
+    e.halfWidth = INFINITY;
+    return e;
+  }
+
+  double ss = 0.0;
+  for (const SampleUnit& u : units) {
+    if (u.accesses == 0) continue;
+    const double r = static_cast<double>(u.hits) - e.hitRate * static_cast<double>(u.accesses);
+    ss += r * r;
+  }
+  const double n = static_cast<double>(e.units);
+  const double t = tQuantile(confidence, e.units - 1);
+  const double fpc = std::max(0.0, 1.0 - sampledFraction);
+  const double accesses = static_cast<double>(e.sampledAccesses);
+  if (ss == 0.0) {
+    const double p = e.hitRate;
+    e.halfWidth = (p == 0.0 || p == 1.0) ? 3.0 / accesses : t * std::sqrt(fpc * p * (1.0 - p) / accesses);
+    return e;
+  }
+  const double meanAccesses = accesses / n;
+  e.halfWidth = t * std::sqrt(fpc * ss / (n - 1.0) / n) / meanAccesses;
+  return e;
+}
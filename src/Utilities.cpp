@@ -1,16 +1,15 @@
-#include <vector>
 #include "Utilities.h"
 #include "Constants.h"
 
-void storeBytes(std::vector<int>::iterator it, int value, int byteCount) {
+void storeBytes(int* it, int value, int byteCount) {
   it += byteCount - 1;
   for (int i = 0; i < byteCount; i++, it--, value >>= 8)
     *it = static_cast<char>(value & 0xFF);
 }
 
-int loadBytes(std::vector<int>::const_iterator it, int byteCount) {
-  int value = 0;
+int loadBytes(const int* it, int byteCount) {
+  unsigned value = 0; // bytes are stored sign-extended; mask before merging
   for (int i = 0; i < byteCount; i++, it++)
-    value = (value << 8) | static_cast<int>(*it);
-  return value;
+    value = (value << 8) | (static_cast<unsigned>(*it) & 0xFF);
+  return static_cast<int>(value);
 }
\ No newline at end of file
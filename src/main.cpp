@@ -1,21 +1,29 @@
+#include <chrono>
 #include <iostream>
 #include <vector>
 #include <random>
 #include <thread>
 #include <iomanip>  // for std::setw, std::setprecision
 #include <memory>   // for std::unique_ptr
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include "OS.h"
 #include "Cache.h"
+#include "Core.h"
+#include "DRAM.h"
+#include "EnergyModel.h"
+#include "Monitor.h"
 #include "Process.h"
+#include "QoS.h"
+#include "Replication.h"
+#include "Sampling.h"
 #include "Constants.h"
 
-// -----------------------------
-// Simple energy model constants
-// -----------------------------
-struct EnergyModel {
-    double E_cache_access = 1.0;   // per cache access (hit or miss)
-    double E_ram_read     = 50.0;  // per RAM read
-    double E_ram_write    = 70.0;  // per RAM write
+struct CoreMemStats {
+    double bandwidth = 0.0;   // bytes per DRAM cycle
+    double rowHitRate = 0.0;
+    double avgLatency = 0.0;  // DRAM cycles per request
 };
 
 struct RunStats {
@@ -23,26 +31,120 @@ struct RunStats {
     int misses = 0;
     int ramReads = 0;
     int ramWrites = 0;
+    int splitAccesses = 0;
+    int fetchHits = 0;
+    int fetchMisses = 0;
+    int invalidations = 0;
+    int upgrades = 0;
+    int coherenceMessages = 0;
     double hitRate = 0.0;
+    double rowHitRate = 0.0;
+    double ramEnergy = 0.0;
+    // Energy breakdown (see EnergyModel)
+    double cacheDynamic = 0.0;
+    double cacheLeakage = 0.0;
+    double icacheEnergy = 0.0;    // private I-caches, split fetch only
+    double gatingEnergy = 0.0;
+    double coherenceEnergy = 0.0;
     double energy = 0.0;
+    long long cycles = 0;         // simulated time, slowest core
+    double activeWays = 0.0;      // access-weighted powered ways
+    // Sampling estimates (see SamplingConfig); counts
+    // above cover detailed accesses only
+    SampleEstimate setEstimate;
+    SampleEstimate windowEstimate;
+    long long totalAccesses = 0;  // data accesses, sampled or not
+    double seconds = 0.0;         // wall time of the run
+    std::vector<CoreMemStats> perCore;
+    std::vector<QoSController::CoreReport> qos; // empty unless QoS ran
 };
 
-static RunStats collectStats(Cache* cache, const EnergyModel& em) {
+static RunStats collectStats(OS* os, const EnergyModel& em) {
+    Cache* cache = os->getCache();
+    DRAM* dram = os->getDRAM();
+    const int numCores = os->getCPU()->getNumCores();
+
     RunStats s;
+    dram->drain(); // retire requests still waiting in the scheduler
     s.hits = cache->getCacheHits();
     s.misses = cache->getCacheMisses();
     s.ramReads = cache->getRamReads();
     s.ramWrites = cache->getRamWrites();
+    s.splitAccesses = cache->getSplitAccesses();
+    s.invalidations = cache->getInvalidations();
+    s.upgrades = cache->getUpgrades();
+    s.coherenceMessages = cache->getCoherenceMessages();
+    if (Core::getFetchMode() == FetchMode::SPLIT) {
+        for (const Core& core : os->getCPU()->getCores()) {
+            s.fetchHits += static_cast<int>(core.getICache().getHits());
+            s.fetchMisses += static_cast<int>(core.getICache().getMisses());
+        }
+    } else {
+        s.fetchHits = cache->getFetchHits();
+        s.fetchMisses = cache->getFetchMisses();
+    }
 
     const int totalCacheAccesses = s.hits + s.misses;
     s.hitRate = (totalCacheAccesses > 0)
         ? static_cast<double>(s.hits) / static_cast<double>(totalCacheAccesses)
         : 0.0;
 
-    const double Ecache = em.E_cache_access * static_cast<double>(totalCacheAccesses);
-    const double Eram   = em.E_ram_read * static_cast<double>(s.ramReads)
-                        + em.E_ram_write * static_cast<double>(s.ramWrites);
-    s.energy = Ecache + Eram;
+    // Simulated time: the run lasts as long as the slowest core's clock
+    const bool split = Core::getFetchMode() == FetchMode::SPLIT;
+    for (int c = 0; c < numCores; ++c)
+        s.cycles = std::max(s.cycles, dram->getCycles(c));
+
+    // Shared cache: only powered ways are read on each access and leak.
+    // Leakage integrates the powered ways over simulated time, so ways
+    // gated or woken mid-run (QoS) are charged for the cycles they were on.
+    const int sets = cache->getNumSets();
+    s.activeWays = cache->getAverageActiveWays();
+    const double activeBytes = s.activeWays * sets * BLOCK_SIZE;
+    const int cacheAccesses = totalCacheAccesses + (split ? 0 : s.fetchHits + s.fetchMisses);
+    s.cacheDynamic = em.accessEnergy(activeBytes, s.activeWays, sets) * cacheAccesses;
+    s.cacheLeakage = em.leakage(static_cast<double>(sets) * BLOCK_SIZE, cache->getActiveWayCycles());
+    s.gatingEnergy = em.E_gate * static_cast<double>(cache->getGateEvents())
+                   + em.E_wakeup * static_cast<double>(cache->getWakeEvents());
+
+    if (split) {
+        for (const Core& core : os->getCPU()->getCores()) {
+            const ICache& ic = core.getICache();
+            const double bytes = static_cast<double>(ic.getNumSets()) * ic.getWays() * BLOCK_SIZE;
+            s.icacheEnergy += em.accessEnergy(bytes, ic.getWays(), ic.getNumSets())
+                                * static_cast<double>(ic.getHits() + ic.getMisses())
+                            + em.leakage(bytes, static_cast<double>(s.cycles));
+        }
+    }
+
+    s.rowHitRate = dram->getRowHitRate();
+    s.ramEnergy = dram->getEnergy();
+    s.coherenceEnergy = em.E_coherence * static_cast<double>(s.coherenceMessages);
+    s.energy = s.cacheDynamic + s.cacheLeakage + s.icacheEnergy + s.gatingEnergy
+             + s.coherenceEnergy + s.ramEnergy;
+
+    const SamplingConfig& sc = cache->getSampling();
+    s.totalAccesses = totalCacheAccesses + cache->getWarmAccesses() + cache->getBypassedAccesses();
+    if (sc.setSampling()) {
+        const std::vector<SampleUnit> units = cache->getSetSamples();
+        s.setEstimate = estimateHitRate(units, static_cast<double>(units.size()) / sets);
+    }
+    if (sc.windowSampling()) {
+        const long long simulated = totalCacheAccesses + cache->getWarmAccesses();
+        s.windowEstimate = estimateHitRate(cache->getWindowSamples(),
+            simulated > 0 ? static_cast<double>(totalCacheAccesses) / static_cast<double>(simulated) : 1.0);
+    }
+
+    for (int c = 0; c < numCores; ++c) {
+        const DRAM::CoreStats& cs = dram->getCoreStats(c);
+        CoreMemStats m;
+        m.bandwidth = dram->getBandwidth(c);
+        m.rowHitRate = dram->getRowHitRate(c);
+        const long long requests = cs.reads + cs.writes;
+        m.avgLatency = (requests > 0)
+            ? static_cast<double>(cs.latency) / static_cast<double>(requests)
+            : 0.0;
+        s.perCore.push_back(m);
+    }
     return s;
 }
 
@@ -127,6 +229,7 @@ static RunStats runOneMode(
         os->loadProcess(processes[static_cast<size_t>(i)]);
 
     // Launch each on its own core; collect threads
+    const auto start = std::chrono::steady_clock::now();
     std::vector<std::thread> workers;
     workers.reserve(static_cast<size_t>(numCores));
     auto& cores = os->getCPU()->getCores();  // reference, not copy
@@ -140,66 +243,287 @@ static RunStats runOneMode(
     }
 
     // Collect stats from cache
-    return collectStats(os->getCache(), em);
+    RunStats s = collectStats(os, em);
+    s.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return s;
 }
 
-int main() {
-    // -----------------------------
-    // Default configuration chosen
-    // to make partitioning useful:
-    // - more cores than ways will
-    //   create contention in shared mode
-    // -----------------------------
-    const int cpuCores   = 4;
-    const int ramBlocks  = 1024;  // RAM blocks
-    const int cacheBlocks= 32;   // total cache blocks
-    const int cacheWays  = 8;    // low associativity to amplify contention
+// -----------------------------
+// Default configuration chosen
+// to make partitioning useful:
+// - more cores than ways will
+//   create contention in shared mode
+// -----------------------------
+struct SimConfig {
+    int cpuCores    = 4;
+    int ramBlocks   = 1024;  // RAM blocks
+    int cacheBlocks = 32;    // total cache blocks
+    int cacheWays   = 8;     // low associativity to amplify contention
 
     // Process sizing:
     // We want processes large enough to churn the cache,
     // but not so large that RAM fills up.
-    const int minProcSize = 200;  // in "words"
-    const int maxProcSize = 400;  // in "words"
-
-    // Energy model
-    EnergyModel em; // use defaults
-
-    std::mt19937 rng(std::random_device{}());
+    int minProcSize = 200;   // in "words"
+    int maxProcSize = 400;   // in "words"
+
+    // Instruction fetch: through the shared cache by
+    // default; codeWays > 0 enables code/data partitioning
+    FetchMode fetchMode = FetchMode::UNIFIED;
+    int codeWays = 0;        // per core partition
+
+    // Switch off ways no core is allocated
+    // (partitioned run only)
+    bool powerGating = false;
+
+    // Set sampling and/or periodic
+    // detailed windows; default = full
+    SamplingConfig sampling;
+
+    // QoS (partitioned run only): per-core classes,
+    // e.g. "lc:0.1,batch:500" (RAM bytes per 1000
+    // simulated cycles); empty = static split
+    std::string qosSpec;
+    long long qosEpoch = 64; // cache accesses per epoch
+};
 
+// -------------------------------------------
+// Build one set of processes and a fresh OS,
+// then run it without and with partitioning.
+// Returns false if the processes don't fit.
+// -------------------------------------------
+static bool runPaired(
+    const SimConfig& cfg,
+    std::mt19937& rng,
+    const EnergyModel& em,
+    RunStats& sShared,
+    RunStats& sPart,
+    bool monitorEnabled = false
+) {
     // Build one set of processes to be reused in both runs
-    makeProcessesForRam(cpuCores, ramBlocks, rng, minProcSize, maxProcSize);
-    if (static_cast<int>(processes.size()) != cpuCores) {
-        std::cerr << "Failed to create exactly numCores processes.\n";
-        return 1;
-    }
+    processes.clear();
+    makeProcessesForRam(cfg.cpuCores, cfg.ramBlocks, rng, cfg.minProcSize, cfg.maxProcSize);
+    if (static_cast<int>(processes.size()) != cfg.cpuCores) return false;
 
     // -----------------------------
     // Run #1: NO PARTITIONING
     // Fresh OS so cache/RAM are clean
     // -----------------------------
-    auto os = OS::createInstance(cpuCores, ramBlocks, cacheBlocks, cacheWays);
+    auto os = OS::createInstance(cfg.cpuCores, cfg.ramBlocks, cfg.cacheBlocks, cfg.cacheWays);
     auto cache = os->getCache();
     auto ram = os->getRAM();
+    cache->setConcurrencyMode(ConcurrencyMode::OPTIMISTIC); // lock-free read hits
+    cache->setCodeWays(cfg.codeWays);
+    cache->setSampling(cfg.sampling);
+    Core::setFetchMode(cfg.fetchMode);
+
+    Monitor monitor(cache);
+    if (monitorEnabled && !monitor.start())
+        std::cerr << "--monitor needs a terminal; continuing without it.\n";
 
-    RunStats sShared = runOneMode(os, /*partitioningEnabled=*/false, em);
+    sShared = runOneMode(os, /*partitioningEnabled=*/false, em);
 
     cache->resetStats(); // clear stats before next run
     ram->clear();      // clear RAM contents before next run
 
     // -----------------------------
     // Run #2: PARTITIONING ENABLED
-    // Fresh OS again (same params)
+    // Same OS, cleared (same params)
     // -----------------------------
-    RunStats sPart = runOneMode(os, /*partitioningEnabled=*/true, em);
+    cache->setPowerGating(cfg.powerGating);
+    std::unique_ptr<QoSController> qos;
+    if (!cfg.qosSpec.empty()) {
+        cache->setPartitioning(true);
+        qos = std::make_unique<QoSController>(
+            cache, os->getDRAM(), QoSController::parseTargets(cfg.qosSpec, cfg.cpuCores), cfg.qosEpoch);
+        qos->attach();
+    }
+
+    sPart = runOneMode(os, /*partitioningEnabled=*/true, em);
+
+    if (qos) {
+        qos->detach();
+        sPart.qos = qos->getReports();
+    }
+
+    monitor.stop(); // restore the terminal before printing
+    return true;
+}
+
+// -------------------------------------------
+// Paired trials until the CIs of the deltas
+// are narrow enough (see ReplicationDriver)
+// -------------------------------------------
+static int runReplication(const SimConfig& cfg, const ReplicationConfig& rc, const EnergyModel& em) {
+    auto trial = [&](unsigned seed) {
+        Process::seedRandom(seed);
+        std::mt19937 rng(seed);
+        RunStats sShared, sPart;
+        if (!runPaired(cfg, rng, em, sShared, sPart))
+            throw std::runtime_error("Failed to create exactly numCores processes.");
+
+        TrialResult r;
+        r.hitRateDelta = sPart.hitRate - sShared.hitRate;
+        r.energyDelta = (sShared.energy > 0.0) ? sPart.energy / sShared.energy - 1.0 : 0.0;
+        return r;
+    };
+    ReplicationReport report;
+    try {
+        report = ReplicationDriver(rc, trial).run();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    auto ciStr = [&](const RunningStat& st, double scale, const char* unit) {
+        std::ostringstream oss;
+        const double hw = st.halfWidth(rc.confidence);
+        oss << std::showpos << std::fixed << std::setprecision(2) << st.getMean() * scale << unit
+            << std::noshowpos << " +/- " << hw * scale << unit;
+        return oss.str();
+    };
+
+    std::cout << "\n================ Replication Summary =================\n";
+    std::cout << "Cores: " << cfg.cpuCores
+              << " | RAM blocks: " << cfg.ramBlocks
+              << " | Cache blocks: " << cfg.cacheBlocks
+              << " | Ways: " << cfg.cacheWays << "\n";
+    std::cout << "Trials: " << report.trials
+              << (report.converged ? " (target CI width reached)" : " (stopped at --max-trials)")
+              << " | Jobs: " << rc.jobs << "\n";
+    // Seeds pick each trial's processes; thread interleaving still varies
+    std::cout << "Process seeds: " << rc.baseSeed << ".."
+              << rc.baseSeed + static_cast<unsigned>(report.trials) - 1
+              << " (interleaving is not reproducible)\n\n";
+    std::cout << std::left << std::setw(24) << "Partitioned - Shared"
+              << "mean +/- " << rc.confidence * 100.0 << "% CI half-width (Student t)\n";
+    std::cout << std::string(64, '-') << "\n";
+    std::cout << std::left << std::setw(24) << "Hit Rate" << ciStr(report.hitRate, 100.0, " pp") << "\n";
+    std::cout << std::left << std::setw(24) << "Energy" << ciStr(report.energy, 100.0, "%") << "\n";
+    std::cout << "======================================================\n\n";
+    return report.converged ? 0 : 2; // 2: stopped at --max-trials
+}
+
+static void usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [--monitor] [--cores N] [--cache-blocks N] [--ways N]\n"
+              << "            [--fetch bypass|split|unified] [--cdp N]\n"
+              << "            [--power-gating] [--sample-sets N] [--sample-windows WARM:DETAIL]\n"
+              << "            [--qos lc:MISS|batch[:BYTES_PER_KCYCLE],... [--qos-epoch N]]\n"
+              << "       " << prog << " --replicate [--ci-width F] [--energy-ci-width F] [--energy-ci-floor F]\n"
+              << "            [--min-trials N] [--max-trials N] [--jobs N] [--seed N]\n"
+              << "       --replicate exits 2 if --max-trials is reached before the CI target;\n"
+              << "       --seed fixes the processes of each trial, not the thread interleaving.\n";
+}
+
+int main(int argc, char** argv) {
+    // -----------------------------
+    // Command line:
+    //   --monitor     live ncurses dashboard
+    //   --replicate   paired trials until the CI target
+    //   --fetch MODE  instruction fetch path
+    //   --cdp N       code ways per core partition
+    //   --qos SPEC    SLA-driven way allocation and throttling
+    //   --power-gating  switch off unallocated ways
+    //   --cores N, --cache-blocks N, --ways N  geometry
+    //   --sample-sets N   simulate every Nth set only
+    //   --sample-windows WARM:DETAIL  SMARTS-style sampling
+    // -----------------------------
+    SimConfig cfg;
+    bool monitorEnabled = false;
+    bool replicate = false;
+    ReplicationConfig rc;
+    rc.jobs = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    rc.baseSeed = std::random_device{}();
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument(arg + " needs a value");
+                return argv[++i];
+            };
+            if (arg == "--monitor") monitorEnabled = true;
+            else if (arg == "--replicate") replicate = true;
+            else if (arg == "--ci-width") rc.hitRateCIWidth = std::stod(value());
+            else if (arg == "--energy-ci-width") rc.energyCIWidth = std::stod(value());
+            else if (arg == "--energy-ci-floor") rc.energyCIFloor = std::stod(value());
+            else if (arg == "--min-trials") rc.minTrials = std::stoi(value());
+            else if (arg == "--max-trials") rc.maxTrials = std::stoi(value());
+            else if (arg == "--jobs") rc.jobs = std::stoi(value());
+            else if (arg == "--seed") rc.baseSeed = static_cast<unsigned>(std::stoul(value()));
+            else if (arg == "--cores") cfg.cpuCores = std::stoi(value());
+            else if (arg == "--cache-blocks") cfg.cacheBlocks = std::stoi(value());
+            else if (arg == "--ways") cfg.cacheWays = std::stoi(value());
+            else if (arg == "--cdp") cfg.codeWays = std::stoi(value());
+            else if (arg == "--power-gating") cfg.powerGating = true;
+            else if (arg == "--sample-sets") {
+                cfg.sampling.setStride = std::stoi(value());
+            }
+            else if (arg == "--sample-windows") {
+                const std::string spec = value();
+                const size_t colon = spec.find(':');
+                if (colon == std::string::npos) throw std::invalid_argument("--sample-windows needs WARM:DETAIL");
+                cfg.sampling.warmLength = std::stoll(spec.substr(0, colon));
+                cfg.sampling.windowLength = std::stoll(spec.substr(colon + 1));
+                if (cfg.sampling.warmLength < 0 || cfg.sampling.windowLength <= 0)
+                    throw std::invalid_argument("--sample-windows needs WARM >= 0 and DETAIL > 0");
+            }
+            else if (arg == "--qos") cfg.qosSpec = value();
+            else if (arg == "--qos-epoch") cfg.qosEpoch = std::stoll(value());
+            else if (arg == "--fetch") {
+                const std::string mode = value();
+                if (mode == "bypass") cfg.fetchMode = FetchMode::BYPASS;
+                else if (mode == "split") cfg.fetchMode = FetchMode::SPLIT;
+                else if (mode == "unified") cfg.fetchMode = FetchMode::UNIFIED;
+                else throw std::invalid_argument("Unknown fetch mode: " + mode);
+            }
+            else throw std::invalid_argument("Unknown option: " + arg);
+        }
+
+        // Validate against the final geometry
+        if (cfg.cpuCores < 1 || cfg.cpuCores > 32)
+            throw std::invalid_argument("--cores must be between 1 and 32");
+        if (cfg.cacheWays < cfg.cpuCores || cfg.cacheWays > 32)
+            throw std::invalid_argument("--ways must be between the number of cores and 32");
+        if (cfg.cacheBlocks <= 0 || cfg.cacheBlocks % cfg.cacheWays != 0)
+            throw std::invalid_argument("--cache-blocks must be a positive multiple of --ways");
+        if (cfg.sampling.setStride < 1 || cfg.sampling.setStride > cfg.cacheBlocks / cfg.cacheWays)
+            throw std::invalid_argument("--sample-sets needs 1 <= N <= number of sets");
+        if (!cfg.qosSpec.empty())
+            QoSController::parseTargets(cfg.qosSpec, cfg.cpuCores);
+        if (cfg.qosEpoch <= 0)
+            throw std::invalid_argument("--qos-epoch must be positive");
+        if (cfg.codeWays < 0 || (cfg.codeWays > 0 && cfg.codeWays >= cfg.cacheWays / cfg.cpuCores))
+            throw std::invalid_argument("--cdp must be smaller than the ways per core (" +
+                                        std::to_string(cfg.cacheWays / cfg.cpuCores) + ")");
+        if (monitorEnabled && replicate)
+            throw std::invalid_argument("--monitor cannot be combined with --replicate");
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Energy model
+    EnergyModel em; // use defaults
+
+    if (replicate) return runReplication(cfg, rc, em);
+
+    std::mt19937 rng(std::random_device{}());
+
+    RunStats sShared, sPart;
+    if (!runPaired(cfg, rng, em, sShared, sPart, monitorEnabled)) {
+        std::cerr << "Failed to create exactly numCores processes.\n";
+        return 1;
+    }
 
     // -----------------------------
     // Summary
     // -----------------------------
     std::cout << "\n================= Simulation Summary =================\n";
-    std::cout << "Cores: " << cpuCores
-              << " | RAM blocks: " << ramBlocks
-              << " | Cache blocks: " << cacheBlocks
-              << " | Ways: " << cacheWays << "\n\n";
+    std::cout << "Cores: " << cfg.cpuCores
+              << " | RAM blocks: " << cfg.ramBlocks
+              << " | Cache blocks: " << cfg.cacheBlocks
+              << " | Ways: " << cfg.cacheWays << "\n\n";
 
     auto printRow = [](const std::string& label, const std::string& shared, const std::string& part) {
         std::cout << std::left << std::setw(24) << label
@@ -230,6 +554,30 @@ int main() {
              rateStr(sShared.hitRate),
              rateStr(sPart.hitRate));
 
+    printRow("I-Fetch Hits",
+             std::to_string(sShared.fetchHits),
+             std::to_string(sPart.fetchHits));
+
+    printRow("I-Fetch Misses",
+             std::to_string(sShared.fetchMisses),
+             std::to_string(sPart.fetchMisses));
+
+    printRow("Invalidations",
+             std::to_string(sShared.invalidations),
+             std::to_string(sPart.invalidations));
+
+    printRow("Upgrades",
+             std::to_string(sShared.upgrades),
+             std::to_string(sPart.upgrades));
+
+    printRow("Coherence Messages",
+             std::to_string(sShared.coherenceMessages),
+             std::to_string(sPart.coherenceMessages));
+
+    printRow("Split-line Accesses",
+             std::to_string(sShared.splitAccesses),
+             std::to_string(sPart.splitAccesses));
+
     printRow("RAM Reads",
              std::to_string(sShared.ramReads),
              std::to_string(sPart.ramReads));
@@ -244,10 +592,130 @@ int main() {
         return oss.str();
     };
 
+    printRow("DRAM Row Hit Rate",
+             rateStr(sShared.rowHitRate),
+             rateStr(sPart.rowHitRate));
+
+    printRow("Simulated Cycles",
+             std::to_string(sShared.cycles),
+             std::to_string(sPart.cycles));
+
+    printRow("Active Ways (avg)",
+             energyStr(sShared.activeWays),
+             energyStr(sPart.activeWays));
+
+    printRow("Cache Dynamic",
+             energyStr(sShared.cacheDynamic),
+             energyStr(sPart.cacheDynamic));
+
+    printRow("Cache Leakage",
+             energyStr(sShared.cacheLeakage),
+             energyStr(sPart.cacheLeakage));
+
+    if (cfg.fetchMode == FetchMode::SPLIT) {
+        printRow("I-Cache Energy",
+                 energyStr(sShared.icacheEnergy),
+                 energyStr(sPart.icacheEnergy));
+    }
+
+    if (cfg.powerGating) {
+        printRow("Gating Overhead",
+                 energyStr(sShared.gatingEnergy),
+                 energyStr(sPart.gatingEnergy));
+    }
+
+    printRow("Coherence Energy",
+             energyStr(sShared.coherenceEnergy),
+             energyStr(sPart.coherenceEnergy));
+
+    printRow("DRAM Energy",
+             energyStr(sShared.ramEnergy),
+             energyStr(sPart.ramEnergy));
+
     printRow("Energy (arbitrary)",
              energyStr(sShared.energy),
              energyStr(sPart.energy));
 
+    std::cout << "\nPer-core DRAM (bandwidth B/cycle, row hit rate, avg latency)\n";
+    std::cout << std::string(64, '-') << "\n";
+    auto memStr = [&](const CoreMemStats& m) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(2) << m.bandwidth << " "
+            << rateStr(m.rowHitRate) << " " << std::setprecision(0) << m.avgLatency;
+        return oss.str();
+    };
+    for (int c = 0; c < cfg.cpuCores; ++c) {
+        printRow("Core " + std::to_string(c),
+                 memStr(sShared.perCore[static_cast<size_t>(c)]),
+                 memStr(sPart.perCore[static_cast<size_t>(c)]));
+    }
+
+    if (!sPart.qos.empty()) {
+        std::cout << "\nQoS (partitioned run, " << sPart.qos[0].met.size() << " epochs; + met, - missed)\n";
+        std::cout << std::string(64, '-') << "\n";
+        for (size_t c = 0; c < sPart.qos.size(); ++c) {
+            const QoSController::CoreReport& r = sPart.qos[c];
+            std::ostringstream target;
+            if (r.target.priority == Priority::LATENCY_CRITICAL)
+                target << "lc miss<=" << rateStr(r.target.maxMissRate);
+            else if (r.target.bandwidthBudget > 0)
+                target << "batch " << r.target.bandwidthBudget << "B/kcyc";
+            else
+                target << "batch";
+            std::cout << std::left << std::setw(8) << ("Core " + std::to_string(c))
+                      << std::setw(18) << target.str()
+                      << "SLA " << std::setw(8) << rateStr(r.attainment())
+                      << "ways " << std::setw(3) << r.allocated
+                      << "thr " << std::setw(8) << rateStr(r.throttle)
+                      << r.timeline(24) << "\n";
+        }
+    }
+
+    if (cfg.sampling.setSampling() || cfg.sampling.windowSampling()) {
+        std::cout << "\nSampling (";
+        if (cfg.sampling.setSampling()) std::cout << "1 in " << cfg.sampling.setStride << " sets";
+        if (cfg.sampling.setSampling() && cfg.sampling.windowSampling()) std::cout << ", ";
+        if (cfg.sampling.windowSampling())
+            std::cout << cfg.sampling.windowLength << " detailed per " << cfg.sampling.warmLength << " warming";
+        std::cout << "; 95% CI)\n";
+        std::cout << std::string(64, '-') << "\n";
+
+        auto estStr = [&](const SampleEstimate& e) {
+            if (e.sampledAccesses == 0) return std::string("n/a");
+            if (e.units < MIN_SAMPLE_UNITS) return rateStr(e.hitRate) + " (n=" + std::to_string(e.units) + ")";
+            return rateStr(e.hitRate) + " +/- " + rateStr(e.halfWidth);
+        };
+        auto sampledStr = [](const RunStats& r) {
+            return std::to_string(r.hits + r.misses) + " / " + std::to_string(r.totalAccesses);
+        };
+        printRow("Detailed / Total", sampledStr(sShared), sampledStr(sPart));
+        if (cfg.sampling.setSampling())
+            printRow("Hit Rate (sets)", estStr(sShared.setEstimate), estStr(sPart.setEstimate));
+        if (cfg.sampling.windowSampling())
+            printRow("Hit Rate (windows)", estStr(sShared.windowEstimate), estStr(sPart.windowEstimate));
+
+        // Extrapolated to every access, from the finest-grained estimate
+        auto missStr = [&](const RunStats& r) {
+            const SampleEstimate& e = cfg.sampling.windowSampling() ? r.windowEstimate : r.setEstimate;
+            if (e.sampledAccesses == 0) return std::string("n/a");
+            std::ostringstream oss;
+            oss << std::fixed << std::setprecision(0) << (1.0 - e.hitRate) * static_cast<double>(r.totalAccesses);
+            if (e.units >= MIN_SAMPLE_UNITS) oss << " +/- " << e.halfWidth * static_cast<double>(r.totalAccesses);
+            return oss.str();
+        };
+        printRow("Est. Misses", missStr(sShared), missStr(sPart));
+        auto msStr = [](double sec) {
+            std::ostringstream oss;
+            oss << std::fixed << std::setprecision(1) << sec * 1000.0 << " ms";
+            return oss.str();
+        };
+        printRow("Wall Time", msStr(sShared.seconds), msStr(sPart.seconds));
+        if (cfg.sampling.windowSampling() &&
+            sShared.windowEstimate.units + sPart.windowEstimate.units < 2 * MIN_SAMPLE_UNITS)
+            std::cout << "Too few detailed windows for an error bound; each core makes about "
+                      << sShared.totalAccesses / cfg.cpuCores << " accesses, use a shorter WARM:DETAIL period.\n";
+    }
+
     std::cout << "======================================================\n\n";
 
     return 0;